@@ -0,0 +1,463 @@
+/* *******************************************************
+ * Nom           : avance.c
+ * Rôle          : Avance rapide des boucles et boucles infinies
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Boucle de machine_executer() plus:
+ *                      - à chaque saut arrière pris vers tete, une
+ *                        itération est exécutée en concret (chemin, sens
+ *                        des branchements, cases écrites) puis en
+ *                        symbolique le long du même chemin. Chaque valeur
+ *                        est une "forme" affine d'une seule case lue au
+ *                        début de l'itération (l'accumulateur compte comme
+ *                        une case de plus). Les cases non écrites par
+ *                        le corps sont des constantes; les pointeurs de
+ *                        *@ doivent en être. Un branchement sur une forme
+ *                        non constante est un test de sortie: on cherche
+ *                        la première itération où il change de sens et on
+ *                        saute au début de cette itération;
+ *                      - Brent sur l'empreinte de l'état (Zobrist).
+ *                 Une valeur qui n'est pas affine (NAND, somme de deux
+ *                 cases) est inconnue: elle ne peut servir ni de
+ *                 pointeur ni de test. Un corps sans test ne sort jamais
+ *                 (ADD# 1; STORE@ x; JUMP@ tete): boucle infinie.
+ *                 Un corps refusé n'est réessayé qu'après 1, 3, 7, ...
+ *                 255 passages (recul exponentiel). Les tableaux de
+ *                 travail sont par thread, hors de la pile (TAILLE_RAM
+ *                 peut valoir 65536), et un appel ne touche que les
+ *                 cases qu'il utilise: reculs marqués du numéro de
+ *                 l'appel, repère de Brent tenu par le journal des cases
+ *                 écrites depuis, empreinte relative à la RAM[] de
+ *                 départ. Un travail court ne paie pas TAILLE_RAM.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include <stdint.h>
+#include "avance.h"
+
+// instructions au plus dans le corps d'une boucle
+#define CORPS_MAX 64
+
+// branchements qui dépendent de l'itération au plus dans le corps
+#define TESTS_MAX 4
+
+// longueur maximale d'une chaîne de cases (x <- y <- z ...)
+#define CHAINE_MAX 8
+
+// itérations essayées pour trouver la sortie: au-delà de CHAINE_MAX
+// itérations, toutes les valeurs sont périodiques (période 256, un mot)
+#define ITERATIONS_MAX ((MASQUE_MOT + 1) + CHAINE_MAX + 1)
+
+// bases d'une forme autres qu'une case de RAM[]: l'accumulateur est la
+// case TAILLE_RAM (sur 32 bits)
+enum { INCONNUE = -2, CONSTANTE = -1, ACCUMULATEUR = TAILLE_RAM };
+
+// valeur pendant une itération, selon l'état au début de l'itération:
+//      INCONNUE : pas affine
+//      CONSTANTE : d
+//      case x : signe * x + d, puis si masque: (& MASQUE_MOT) + apres
+typedef struct {
+    int base;
+    int signe;
+    int d;
+    bool masque;
+    int apres;
+} forme;
+
+// branchement dont le sens dépend de l'itération
+typedef struct {
+    forme accumulateur;
+    bool brz; // BRZ@, sinon BRN@
+    bool pris; // sens à l'itération 0, qui reste dans la boucle
+} test_boucle;
+
+// une itération du corps d'une boucle
+typedef struct {
+    int longueur; // instructions (cycles) par itération
+    int pc[CORPS_MAX];
+    bool pris[CORPS_MAX];
+    bool ecrite[TAILLE_RAM]; // cases écrites par le corps
+    int ecrites[TAILLE_RAM];
+    int nb_ecrites;
+    forme fin[TAILLE_RAM + 1]; // cases écrites et accumulateur, en fin d'itération
+    test_boucle tests[TESTS_MAX];
+    int nb_tests;
+    const mot* depart; // RAM[] au début de l'itération 0
+    int accumulateur; // au début de l'itération 0
+} corps_boucle;
+
+// issue d'une tentative d'avance rapide
+typedef enum { BOUCLE_REFUSEE, BOUCLE_SAUTEE, BOUCLE_INFINIE } issue_boucle;
+
+// état gardé par l'algorithme de Brent: RAM[] n'est pas copiée, les
+// cases écrites depuis le repère gardent leur valeur d'alors (journal)
+typedef struct {
+    uint64_t empreinte;
+    int PC;
+    int accumulateur;
+    size_t pos_entree;
+    unsigned long puissance, lambda;
+    int nb_ecrites; // cases du journal
+} repere_brent;
+
+// journal du repère: cases écrites, marquées du numéro du repère
+static __thread int journal[TAILLE_RAM];
+static __thread mot valeur_repere[TAILLE_RAM];
+static __thread unsigned marque_repere[TAILLE_RAM], numero_repere;
+
+// recul d'une boucle, valable pendant l'appel numero_appel
+typedef struct {
+    unsigned appel;
+    unsigned char echecs, report;
+} recul_boucle;
+
+static __thread recul_boucle reculs[TAILLE_RAM];
+static __thread unsigned numero_appel;
+
+
+static forme constante(int c){
+    return (forme) { CONSTANTE, 1, c, false, 0 };}
+
+
+static forme inconnue(void){
+    return (forme) { INCONNUE, 1, 0, false, 0 };}
+
+
+static forme ajouter(forme f, int k){
+    if (f.masque) f.apres += k;
+    else f.d += k;
+    return f;}
+
+
+// valeur rangée dans RAM[] (un mot, 8 bits par défaut)
+static forme masquer(forme f){
+
+    if (f.base == CONSTANTE) return constante(f.d & MASQUE_MOT);
+    if (f.base == INCONNUE) return f;
+    if (f.masque) f.d += f.apres;
+    f.d &= MASQUE_MOT;
+    f.apres = 0;
+    f.masque = (f.signe != 1) || (f.d != 0) || (f.base == ACCUMULATEUR); // RAM[x] seul tient déjà dans un mot
+    return f;}
+
+
+// -f, faux si f est masquée (non affine)
+static bool opposer(forme* f){
+
+    if ((f->base != CONSTANTE) && (f->masque)) return false;
+    f->signe = -f->signe;
+    f->d = -f->d;
+    return true;}
+
+
+// f + g ou f - g, inconnue si les deux dépendent de l'itération
+static forme combiner(forme f, forme g, bool soustraire){
+
+    if (g.base == CONSTANTE) return ajouter(f, soustraire ? -g.d : g.d);
+    if ((f.base != CONSTANTE) || (g.base == INCONNUE)) return inconnue();
+    if (soustraire && !opposer(&g)) return inconnue();
+    return ajouter(g, f.d);}
+
+
+// case x pendant l'itération symbolique
+static forme lire(const corps_boucle* c, const forme* cases, int x){
+    return c->ecrite[x] ? cases[x] : constante(c->depart[x]);}
+
+
+static int evaluer(const corps_boucle* c, forme f, unsigned long i);
+
+// case x (ou accumulateur) au début de l'itération i
+static int valeur(const corps_boucle* c, int x, unsigned long i){
+
+    if (x == ACCUMULATEUR) {
+        if ((i == 0) || (c->fin[x].base == x)) return c->accumulateur;} // inchangé
+    else {
+        if ((!c->ecrite[x]) || (i == 0)) return c->depart[x];
+        if (c->fin[x].base == x) return (c->depart[x] + (int) ((i & MASQUE_MOT) * (unsigned) c->fin[x].d)) & MASQUE_MOT;} // x <- x + d
+    return evaluer(c, c->fin[x], i - 1);}
+
+
+// valeur de f pendant l'itération i
+static int evaluer(const corps_boucle* c, forme f, unsigned long i){
+
+    if (f.base == CONSTANTE) return f.d;
+    int v = f.signe * valeur(c, f.base, i) + f.d;
+    return f.masque ? (v & MASQUE_MOT) + f.apres : v;}
+
+
+// exécute une itération en concret depuis tete; faux si le corps ne
+// revient pas en tete, lit une entrée, affiche ou est trop long
+// (sur m, dont les cases écrites reprennent ensuite leur valeur)
+static bool parcourir(machine* m, int tete, int accumulateur, corps_boucle* c){
+
+    int PC = tete, n = 0, j, lieux[CORPS_MAX];
+    mot anciennes[CORPS_MAX];
+    bool revenu = false;
+    for (j=0; j < c->nb_ecrites; j++) c->ecrite[c->ecrites[j]] = false; // parcours précédent
+    c->nb_ecrites = 0;
+
+    while ((n < CORPS_MAX) && PC_VALIDE(PC)){
+        int opcode = m->RAM[PC], argument = ADRESSE(m->RAM[PC+1]);
+        unsigned acces = acces_opcode[OPCODE(opcode)];
+        if ((!nom_mnemonique[OPCODE(opcode)]) || (opcode == IN_AT) || (opcode == IN_STAR_AT)
+                || (opcode == OUT_SHARP) || (opcode == OUT_AT) || (opcode == OUT_STAR_AT)) break;
+        lieux[n] = -1;
+        if (acces & (ACCES_ECRIT | ACCES_ECRIT_IND)) {
+            int x = (acces & ACCES_ECRIT) ? argument : ADRESSE(m->RAM[argument]);
+            lieux[n] = x;
+            anciennes[n] = m->RAM[x];
+            if (!c->ecrite[x]) {c->ecrite[x] = true; c->ecrites[c->nb_ecrites++] = x;}}
+        c->pc[n] = PC;
+        executer_instruction(m, &PC, &accumulateur, false);
+        c->pris[n] = (PC != c->pc[n] + 2);
+        n++;
+        if (PC == tete) {revenu = true; break;}}
+
+    for (j=n-1; j >= 0; j--) if (lieux[j] >= 0) m->RAM[lieux[j]] = anciennes[j];
+    c->longueur = n;
+    return revenu;}
+
+
+// exécute le même chemin en symbolique; faux si un pointeur varie ou si
+// un test porte sur une valeur inconnue
+static bool symboliser(corps_boucle* c){
+
+    static __thread forme cases[TAILLE_RAM];
+    forme acc = { ACCUMULATEUR, 1, 0, false, 0 };
+    int j;
+    for (j=0; j < c->nb_ecrites; j++) cases[c->ecrites[j]] = (forme) { c->ecrites[j], 1, 0, false, 0 };
+    c->nb_tests = 0;
+
+    for (j=0; j < c->longueur; j++){
+        int opcode = c->depart[c->pc[j]], argument = c->depart[c->pc[j] + 1], x = ADRESSE(argument);
+        unsigned acces = acces_opcode[OPCODE(opcode)];
+
+        // *@: même case à chaque itération
+        if (acces & (ACCES_LIT_IND | ACCES_ECRIT_IND)) {
+            forme pointeur = lire(c, cases, x);
+            if (pointeur.base != CONSTANTE) return false;
+            x = ADRESSE(pointeur.d);}
+
+        switch (opcode){
+            case LOAD_SHARP: acc = constante(argument); break;
+            case LOAD_AT: case LOAD_STAR_AT: acc = lire(c, cases, x); break;
+            case ADD_SHARP: acc = ajouter(acc, argument); break;
+            case SUB_SHARP: acc = ajouter(acc, -argument); break;
+            case ADD_AT: case ADD_STAR_AT: acc = combiner(acc, lire(c, cases, x), false); break;
+            case SUB_AT: case SUB_STAR_AT: acc = combiner(acc, lire(c, cases, x), true); break;
+            case NAND_SHARP: case NAND_AT: case NAND_STAR_AT: {
+                forme g = (opcode == NAND_SHARP) ? constante(argument) : lire(c, cases, x);
+                acc = ((acc.base == CONSTANTE) && (g.base == CONSTANTE)) ? constante(~(acc.d & g.d)) : inconnue();
+                break;}
+            case STORE_AT: case STORE_STAR_AT:
+                if (!c->ecrite[x]) return false;
+                cases[x] = masquer(acc);
+                break;
+            case BRN_AT: case BRZ_AT: // une constante prend le même sens à chaque itération
+                if (acc.base == CONSTANTE) break;
+                if ((acc.base == INCONNUE) || (c->nb_tests == TESTS_MAX)) return false;
+                c->tests[c->nb_tests++] = (test_boucle) { acc, opcode == BRZ_AT, c->pris[j] };
+                break;
+            default: break;}} // JUMP@
+
+    for (j=0; j < c->nb_ecrites; j++) c->fin[c->ecrites[j]] = cases[c->ecrites[j]];
+    c->fin[ACCUMULATEUR] = acc;
+    return true;}
+
+
+// le corps ne modifie pas son code
+static bool code_intact(const corps_boucle* c){
+
+    int j;
+    for (j=0; j < c->longueur; j++)
+        if (c->ecrite[c->pc[j]] || c->ecrite[c->pc[j] + 1]) return false;
+    return true;}
+
+
+// chaque case écrite se calcule pour toute itération: chaîne courte
+// jusqu'à une constante, une case x <- x + d (sur un mot) ou
+// l'accumulateur inchangé
+static bool valider(const corps_boucle* c){
+
+    int j, n;
+    for (j=0; j <= c->nb_ecrites; j++){
+        int x = (j < c->nb_ecrites) ? c->ecrites[j] : ACCUMULATEUR;
+        for (n=0; n <= CHAINE_MAX; n++){
+            forme f = c->fin[x];
+            if (f.base == INCONNUE) return false;
+            if (f.base == CONSTANTE) break;
+            if (f.base == x) {
+                if ((f.signe != 1) || ((x == ACCUMULATEUR) && (f.masque || (f.d != 0)))) return false;
+                break;}
+            x = f.base;}
+        if (n > CHAINE_MAX) return false;}
+    return true;}
+
+
+// première itération (1 ou plus) où un test change de sens, 0 si aucune
+static unsigned long trouver_sortie(const corps_boucle* c){
+
+    unsigned long i;
+    int t;
+    for (i=1; i <= ITERATIONS_MAX; i++)
+        for (t=0; t < c->nb_tests; t++){
+            int v = evaluer(c, c->tests[t].accumulateur, i);
+            bool pris = c->tests[t].brz ? (v == 0) : ((v & BIT_SIGNE) != 0);
+            if (pris != c->tests[t].pris) return i;}
+    return 0;}
+
+
+// mélange de splitmix64
+static inline uint64_t melanger(uint64_t x){
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);}
+
+
+// part de RAM[a] = v dans l'empreinte (Zobrist)
+static inline uint64_t zobrist(int a, int v){
+    return melanger((1ULL << 40) | (a << 8) | v);}
+
+
+// empreinte de l'état complet
+static inline uint64_t empreinte_etat(uint64_t empreinte_RAM, int PC, int accumulateur, size_t pos_entree){
+    return empreinte_RAM ^ melanger((2ULL << 40) | ((uint64_t) (uint32_t) accumulateur << 8) | PC) ^ melanger((3ULL << 40) ^ pos_entree);}
+
+
+// RAM[x] valait ancienne au repère si x n'a pas été écrite depuis
+static inline void noter(repere_brent* r, int x, mot ancienne){
+
+    if (marque_repere[x] == numero_repere) return;
+    marque_repere[x] = numero_repere;
+    valeur_repere[x] = ancienne;
+    journal[r->nb_ecrites++] = x;}
+
+
+// saute les itérations de la boucle en tete qui ne sortent pas
+static issue_boucle sauter_boucle(machine* m, int tete, int* accumulateur, unsigned long* compteur, unsigned long limite, uint64_t* empreinte, repere_brent* repere){
+
+    static __thread corps_boucle c;
+    c.depart = m->RAM;
+    c.accumulateur = *accumulateur;
+    if ((!parcourir(m, tete, *accumulateur, &c)) || (!symboliser(&c)) || (!code_intact(&c))) return BOUCLE_REFUSEE;
+
+    // aucun test ne dépend de l'itération: le même chemin pour toujours,
+    // même si des valeurs croissent sans borne
+    if (c.nb_tests == 0) return BOUCLE_INFINIE;
+    if (!valider(&c)) return BOUCLE_REFUSEE;
+
+    unsigned long n = trouver_sortie(&c);
+    if (n == 0) return BOUCLE_INFINIE;
+    if (n > (limite - *compteur) / c.longueur) n = (limite - *compteur) / c.longueur;
+    if (n == 0) return BOUCLE_REFUSEE;
+
+    // tout se calcule sur la RAM[] de l'itération 0
+    static __thread mot nouvelles[TAILLE_RAM];
+    int j;
+    for (j=0; j < c.nb_ecrites; j++) nouvelles[c.ecrites[j]] = valeur(&c, c.ecrites[j], n);
+    *accumulateur = valeur(&c, ACCUMULATEUR, n);
+    for (j=0; j < c.nb_ecrites; j++){
+        int x = c.ecrites[j];
+        *empreinte ^= zobrist(x, m->RAM[x]) ^ zobrist(x, nouvelles[x]);
+        noter(repere, x, m->RAM[x]);
+        m->RAM[x] = nouvelles[x];}
+    *compteur += n * c.longueur;
+    return BOUCLE_SAUTEE;}
+
+
+// garde l'état courant comme repère de Brent (journal vide)
+static void garder(repere_brent* r, const machine* m, int PC, int accumulateur, uint64_t empreinte){
+    r->empreinte = empreinte;
+    r->PC = PC;
+    r->accumulateur = accumulateur;
+    r->pos_entree = m->pos_entree;
+    r->nb_ecrites = 0;
+    if (++numero_repere == 0) {memset(marque_repere, 0, sizeof(marque_repere)); numero_repere = 1;}}
+
+
+// RAM[] de m est-elle celle du repère ? (seules les cases du journal ont pu changer)
+static bool meme_RAM(const repere_brent* r, const mot* RAM){
+
+    int j;
+    for (j=0; j < r->nb_ecrites; j++)
+        if (RAM[journal[j]] != valeur_repere[journal[j]]) return false;
+    return true;}
+
+
+// recul de la boucle en tete, remis à zéro au premier accès de l'appel
+static recul_boucle* recul(int tete){
+
+    recul_boucle* b = &reculs[tete];
+    if (b->appel != numero_appel) {b->appel = numero_appel; b->echecs = b->report = 0;}
+    return b;}
+
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire, budget ou boucle infinie
+raison_arret avance_executer(machine* m, unsigned long budget){
+
+    int PC = m->PC, accumulateur = m->accumulateur, a;
+    unsigned long compteur = m->compteur;
+    unsigned long limite = budget ? compteur + budget : (unsigned long) -1;
+    if (++numero_appel == 0) {memset(reculs, 0, sizeof(reculs)); numero_appel = 1;}
+
+    // empreinte de RAM[] xor celle de la RAM[] de départ: seules les
+    // écritures la changent, la comparaison reste la même
+    uint64_t empreinte = 0;
+    static __thread repere_brent repere;
+    garder(&repere, m, PC, accumulateur, empreinte_etat(empreinte, PC, accumulateur, m->pos_entree));
+    repere.puissance = 1;
+    repere.lambda = 0;
+
+    m->raison = ARRET_AUCUN;
+    while (PC_VALIDE(PC)){
+        if (compteur >= limite) {m->raison = ARRET_BUDGET; break;}
+        compteur ++;
+
+        // case écrite par l'instruction (empreinte tenue à jour)
+        int opcode = m->RAM[PC], precedent = PC, ancienne = 0;
+        unsigned acces = acces_opcode[OPCODE(opcode)];
+        a = (acces & ACCES_ECRIT) ? ADRESSE(m->RAM[PC+1]) : (acces & ACCES_ECRIT_IND) ? ADRESSE(CASE(m->RAM, m->RAM[PC+1])) : -1;
+        if (a >= 0) ancienne = m->RAM[a];
+        if (executer_instruction(m, &PC, &accumulateur, false)) break;
+        if (a >= 0) {
+            empreinte ^= zobrist(a, ancienne) ^ zobrist(a, m->RAM[a]);
+            noter(&repere, a, ancienne);}
+
+        // saut arrière pris: peut-être une boucle de comptage
+        if ((PC <= precedent) && ((opcode == JUMP_AT) || (opcode == BRN_AT) || (opcode == BRZ_AT)) && PC_VALIDE(PC)){
+            recul_boucle* b = recul(PC);
+            if (b->report) b->report--;
+            else switch (sauter_boucle(m, PC, &accumulateur, &compteur, limite, &empreinte, &repere)){
+                case BOUCLE_INFINIE: m->raison = ARRET_BOUCLE; break;
+                case BOUCLE_SAUTEE: b->echecs = 0; break;
+                case BOUCLE_REFUSEE:
+                    if (b->echecs < 8) b->echecs++;
+                    b->report = (1 << b->echecs) - 1;
+                    break;}
+            if (m->raison == ARRET_BOUCLE) break;}
+
+        // Brent: état déjà vu = boucle infinie (une entrée de stdin
+        // n'est pas dans l'état: on repart de zéro)
+        uint64_t etat = empreinte_etat(empreinte, PC, accumulateur, m->pos_entree);
+        if (((opcode == IN_AT) || (opcode == IN_STAR_AT)) && (!m->entrees_tampon)) {
+            garder(&repere, m, PC, accumulateur, etat);
+            repere.puissance = 1;
+            repere.lambda = 0;
+            continue;}
+        if ((etat == repere.empreinte) && (PC == repere.PC) && (accumulateur == repere.accumulateur)
+                && (m->pos_entree == repere.pos_entree) && meme_RAM(&repere, m->RAM)) {
+            m->raison = ARRET_BOUCLE; break;}
+        if (++repere.lambda == repere.puissance){
+            garder(&repere, m, PC, accumulateur, etat);
+            repere.puissance *= 2;
+            repere.lambda = 0;}}
+
+    if (m->raison == ARRET_AUCUN) m->raison = ARRET_PC;
+    m->PC = PC; m->accumulateur = accumulateur; m->compteur = compteur;
+    return m->raison;}
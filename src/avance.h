@@ -0,0 +1,48 @@
+/* *******************************************************
+ * Nom           : avance.h
+ * Rôle          : Avance rapide des boucles et boucles infinies
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Même sémantique que machine_executer() (résultat,
+ *                 accumulateur, RAM[] et nombre de cycles), avec deux
+ *                 raccourcis:
+ *                      - boucle de comptage: à chaque saut arrière pris,
+ *                        une itération du corps est exécutée en symbolique.
+ *                        Si chaque case écrite et l'accumulateur sont
+ *                        affines (x <- x + d ou dérivés d'une telle case,
+ *                        accumulateur inchangé ou recopié d'une case), on
+ *                        calcule la première itération qui sort et on y
+ *                        saute d'un coup (multiplication, division par
+ *                        additions / soustractions répétées);
+ *                      - boucle infinie: l'état complet (RAM[], PC,
+ *                        accumulateur, position des entrées) a une
+ *                        empreinte de Zobrist tenue à jour à chaque
+ *                        écriture. L'algorithme de Brent compare l'état
+ *                        courant à un état gardé aux puissances de 2. Une
+ *                        répétition (vérifiée en entier, pas seulement
+ *                        l'empreinte) prouve que la machine ne s'arrêtera
+ *                        pas: arrêt ARRET_BOUCLE. Une boucle de comptage
+ *                        dont aucune itération ne sort est aussi une
+ *                        boucle infinie, comme un corps dont aucun
+ *                        branchement ne dépend de l'itération, même si
+ *                        ses valeurs croissent sans borne (ADD# 1;
+ *                        STORE@ x; JUMP@ tete).
+ *                 Un IN@ lu sur stdin remet la détection à zéro (l'entrée
+ *                 ne fait pas partie de l'état).
+ *
+ * ****************************************************** */
+
+#ifndef AVANCE_H
+#define AVANCE_H
+
+#include "machine.h"
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire, budget ou boucle
+// infinie prouvée; budget = nombre maximal de cycles, 0 = illimité
+raison_arret avance_executer(machine* m, unsigned long budget);
+
+#endif
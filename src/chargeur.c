@@ -0,0 +1,251 @@
+/* *******************************************************
+ * Nom           : chargeur.c
+ * Rôle          : Chargement des programmes (texte ou binaire) + cache
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Remplace un fscanf("%x") par byte: même résultat
+ *                 (mots séparés par des blancs, préfixe 0x facultatif,
+ *                 arrêt au premier mot illisible ou à la fin de RAM[]),
+ *                 sans appel de bibliothèque par caractère.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "chargeur.h"
+
+// au-delà, le fichier est projeté en mémoire plutôt que lu
+#define PETIT_FICHIER 16384
+
+// classe de chaque caractère: 0-15 chiffre hexadécimal, BLANC, AUTRE
+enum { BLANC = 16, AUTRE = 17 };
+
+// table des chiffres, remplie au premier appel
+static unsigned char classe[256];
+
+// cache: table à adressage ouvert, indexée par l'empreinte
+static const image_programme** cache = NULL;
+static size_t taille_cache = 0, nb_cache = 0;
+
+
+static void remplir_classes(void){
+
+    int c;
+    for (c=0; c < 256; c++) classe[c] = AUTRE;
+    for (c='0'; c <= '9'; c++) classe[c] = c - '0';
+    for (c='a'; c <= 'f'; c++) classe[c] = c - 'a' + 10;
+    for (c='A'; c <= 'F'; c++) classe[c] = c - 'A' + 10;
+    classe[' '] = classe['\t'] = classe['\n'] = classe['\r'] = classe['\v'] = classe['\f'] = BLANC;}
+
+
+// analyse un programme texte de n bytes, renvoie le nombre de mots chargés
+int analyser_texte(const char* texte, size_t n, mot* RAM, int chargement){
+
+    const unsigned char* p = (const unsigned char*) texte;
+    const unsigned char* fin = p + n;
+    int h = chargement;
+
+    if (classe[0] == 0) remplir_classes(); // '\0' est AUTRE une fois remplie
+
+    while (h < TAILLE_RAM){
+        while ((p < fin) && (classe[*p] == BLANC)) p++;
+        if (p == fin) break;
+
+        // signe et préfixe 0x facultatifs, comme "%x"
+        bool negatif = (*p == '-');
+        if ((*p == '-') || (*p == '+')) p++;
+        if ((fin - p >= 3) && (p[0] == '0') && ((p[1] | 0x20) == 'x') && (classe[p[2]] < 16)) p += 2;
+
+        if ((p == fin) || (classe[*p] >= 16)) break; // mot illisible: fin du chargement
+        unsigned valeur = 0;
+        while ((p < fin) && (classe[*p] < 16)) valeur = (valeur << 4) | classe[*p++];
+        RAM[h++] = (mot) (negatif ? -valeur : valeur);}
+
+    return h - chargement;}
+
+
+// empreinte FNV-1a 64 bits
+static uint64_t empreinte(const unsigned char* p, size_t n, uint64_t h){
+
+    size_t i;
+    for (i=0; i < n; i++) h = (h ^ p[i]) * 0x100000001b3ULL;
+    return h;}
+
+
+// image du cache de même contenu (et même adresse pour le texte):
+// l'empreinte trie, le contenu décide (collisions)
+static const image_programme* chercher(uint64_t e, const unsigned char* contenu, size_t n, bool binaire, int chargement){
+
+    if (taille_cache == 0) return NULL;
+    size_t i = e & (taille_cache - 1);
+    while (cache[i]){
+        const image_programme* im = cache[i];
+        if ((im->empreinte == e) && (im->binaire == binaire) && (im->taille_fichier == n)
+                && (binaire || (im->chargement == chargement)) && (memcmp(im->fichier, contenu, n) == 0)) return im;
+        i = (i + 1) & (taille_cache - 1);}
+    return NULL;}
+
+
+// ajoute une image au cache (double la table à moitié pleine)
+static void ranger(const image_programme* im){
+
+    if (2 * (nb_cache + 1) > taille_cache){
+        size_t ancienne = taille_cache, i;
+        const image_programme** anciennes = cache;
+        taille_cache = taille_cache ? 2 * taille_cache : 64;
+        cache = calloc(taille_cache, sizeof(*cache));
+        if (!cache) {
+            perror("allocation du cache des programmes (ranger)");
+            exit(EXIT_FAILURE);}
+        nb_cache = 0;
+        for (i=0; i < ancienne; i++) if (anciennes[i]) ranger(anciennes[i]);
+        free(anciennes);}
+
+    size_t i = im->empreinte & (taille_cache - 1);
+    while (cache[i]) i = (i + 1) & (taille_cache - 1);
+    cache[i] = im;
+    nb_cache++;}
+
+
+// l'image binaire a-t-elle été écrite pour la configuration de la machine ?
+static bool configuration_image(const entete_image* entete){
+#if IMAGE_LARGE
+    return (entete->bits_adresse == CX25_BITS_ADRESSE) && (entete->bits_accumulateur == CX25_BITS_ACCUMULATEUR);
+#else
+    (void) entete;
+    return true; // la magie suffit
+#endif
+}
+
+
+// image du contenu (n bytes, texte ou binaire), analysée ou trouvée dans
+// le cache; NULL si invalide (errno)
+static const image_programme* interner(const unsigned char* contenu, size_t n, bool binaire, int chargement){
+
+    // le texte dépend aussi de l'adresse de chargement
+    uint64_t e = empreinte(contenu, n, 0xcbf29ce484222325ULL);
+    if (!binaire) e = empreinte((const unsigned char*) &chargement, sizeof(chargement), e);
+
+    const image_programme* trouvee = chercher(e, contenu, n, binaire, chargement);
+    if (trouvee) return trouvee;
+
+    entete_image entete;
+    if (binaire){
+        memcpy(&entete, contenu, sizeof(entete));
+        if ((entete.chargement + entete.taille > TAILLE_RAM) || (sizeof(entete) + entete.taille * sizeof(mot) > n) || (!configuration_image(&entete))){
+            errno = EINVAL;
+            return NULL;}}
+    else if ((chargement < 0) || (chargement >= TAILLE_RAM)){
+        errno = EINVAL;
+        return NULL;}
+
+    image_programme* im = calloc(1, sizeof(image_programme));
+    if (!im) {
+        perror("allocation d'un programme (charger_image)");
+        exit(EXIT_FAILURE);}
+    im->empreinte = e;
+    im->binaire = binaire;
+    im->fichier = malloc(n ? n : 1);
+    if (!im->fichier) {
+        perror("allocation d'un programme (charger_image)");
+        exit(EXIT_FAILURE);}
+    memcpy(im->fichier, contenu, n);
+    im->taille_fichier = n;
+
+    if (binaire){
+        im->chargement = entete.chargement;
+        im->depart = entete.depart;
+        im->taille = entete.taille;
+        memcpy(&im->RAM[im->chargement], contenu + sizeof(entete), im->taille * sizeof(mot));}
+    else {
+        im->chargement = im->depart = chargement;
+        im->taille = analyser_texte((const char*) contenu, n, im->RAM, chargement);}
+
+    ranger(im);
+    return im;}
+
+
+// lit chemin (texte chargé à chargement, ou image binaire), via le cache
+const image_programme* charger_image(const char* chemin, int chargement){
+
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {close(fd); return NULL;}
+
+    // petit fichier: un read() coûte moins qu'un mmap() + munmap()
+    size_t n = st.st_size;
+    unsigned char petit[PETIT_FICHIER];
+    const unsigned char* contenu = petit;
+    bool projete = (n > PETIT_FICHIER);
+    if (projete){
+        contenu = mmap(NULL, n, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (contenu == MAP_FAILED) {close(fd); return NULL;}}
+    else {
+        ssize_t lus = read(fd, petit, n);
+        if (lus < 0) {close(fd); return NULL;}
+        n = lus;}
+    close(fd);
+
+    bool binaire = (n >= sizeof(entete_image)) && (memcmp(contenu, MAGIE_IMAGE, 8) == 0);
+
+    // image écrite pour une autre configuration (CX25IMG / CX25IMW)
+    if ((!binaire) && (n >= 8) && (memcmp(contenu, MAGIE_IMAGE, 6) == 0)) {
+        if (projete) munmap((void*) contenu, n);
+        errno = EINVAL;
+        return NULL;}
+
+    const image_programme* im = interner(contenu, n, binaire, chargement);
+    int erreur = errno;
+    if (projete) munmap((void*) contenu, n);
+    errno = erreur;
+    return im;}
+
+
+// programme texte de n bytes déjà en mémoire, chargé à chargement, via
+// le cache: les mêmes bytes rendent la même image
+const image_programme* charger_texte(const char* texte, size_t n, int chargement){
+
+    return interner((const unsigned char*) texte, n, false, chargement);}
+
+
+// écrit le programme en image binaire, false si erreur (errno)
+bool ecrire_image(const char* chemin, const image_programme* im){
+
+    entete_image entete = { .magie = MAGIE_IMAGE, .chargement = im->chargement, .depart = im->depart, .taille = im->taille };
+#if IMAGE_LARGE
+    entete.bits_adresse = CX25_BITS_ADRESSE;
+    entete.bits_accumulateur = CX25_BITS_ACCUMULATEUR;
+#endif
+    FILE* fichier = fopen(chemin, "wb");
+    if (!fichier) return false;
+    bool ok = (fwrite(&entete, sizeof(entete), 1, fichier) == 1)
+        && (fwrite(&im->RAM[im->chargement], sizeof(mot), im->taille, fichier) == (size_t) im->taille);
+    return (fclose(fichier) == 0) && ok;}
+
+
+// l'adresse de départ convient-elle au programme ?
+const char* valider_depart(const image_programme* im, int depart){
+
+    static __thread char message[200]; // un par thread (cx25_serveur)
+
+    if (im->binaire && (depart != im->depart)){
+        snprintf(message, sizeof(message), "Ce programme démarre à l'adresse 0x%02X (en-tête de l'image), pas 0x%02X.", im->depart, depart);
+        return message;}
+    if (!PC_VALIDE(depart)){
+        snprintf(message, sizeof(message), "L'adresse de début doit être comprise entre 0x20 et 0x%X.", TAILLE_RAM - 2);
+        return message;}
+    if ((depart < im->chargement) || (depart >= im->chargement + im->taille))
+        return "L'adresse de début n'est pas dans le programme chargé.";
+    if (!nom_mnemonique[OPCODE(im->RAM[depart])]){
+        snprintf(message, sizeof(message), "L'adresse de début 0x%02X ne contient pas une instruction connue (0x%02x).", depart, im->RAM[depart]);
+        return message;}
+    return NULL;}
@@ -0,0 +1,92 @@
+/* *******************************************************
+ * Nom           : chargeur.h
+ * Rôle          : Chargement des programmes (texte ou binaire) + cache
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Deux formats de programme:
+ *                      - texte: une valeur hexadécimale par mot (0x49
+ *                        ou 49), chargée à l'adresse donnée, qui est
+ *                        aussi l'adresse de départ;
+ *                      - image binaire: une entete_image (adresses de
+ *                        chargement et de départ) puis les bytes (les
+ *                        mots d'une machine large, voir machine.h).
+ *                 Le fichier est lu d'un coup (projeté en mémoire avec
+ *                 mmap s'il est grand) et analysé en une passe avec une
+ *                 table des chiffres hexadécimaux.
+ *
+ *                 Les images déjà analysées sont gardées dans un cache
+ *                 indexé par l'empreinte du contenu (FNV-1a 64 bits):
+ *                 un même programme sous plusieurs noms n'est analysé
+ *                 qu'une fois. Une copie du fichier est gardée et
+ *                 comparée avant de rendre une image du cache (deux
+ *                 contenus peuvent avoir la même empreinte). Le cache n'est pas protégé par un verrou:
+ *                 charger depuis un seul thread.
+ *
+ * ****************************************************** */
+
+#ifndef CHARGEUR_H
+#define CHARGEUR_H
+
+#include <stdint.h>
+#include "machine.h"
+
+// début d'une image binaire
+#if (CX25_BITS_ADRESSE == 8) && (CX25_BITS_ACCUMULATEUR == 8)
+#define IMAGE_LARGE 0
+#define MAGIE_IMAGE "CX25IMG"
+typedef struct {
+    char magie[8]; // "CX25IMG"
+    uint8_t chargement; // adresse du premier byte
+    uint8_t depart; // adresse de départ du PC
+    uint16_t taille; // nombre de bytes qui suivent
+} entete_image;
+#else
+// machine large: les mots suivent l'en-tête, une image ne se relit
+// qu'avec la même largeur de mots et d'adresses
+#define IMAGE_LARGE 1
+#define MAGIE_IMAGE "CX25IMW"
+typedef struct {
+    char magie[8]; // "CX25IMW"
+    uint8_t bits_adresse; // CX25_BITS_ADRESSE
+    uint8_t bits_accumulateur; // CX25_BITS_ACCUMULATEUR
+    uint16_t chargement;
+    uint16_t depart;
+    uint32_t taille; // nombre de mots qui suivent
+} entete_image;
+#endif
+
+// programme prêt à copier dans une machine
+typedef struct {
+    uint64_t empreinte; // contenu du fichier (+ adresse pour le texte)
+    unsigned char* fichier; // copie du contenu, comparée à chaque succès du cache
+    size_t taille_fichier;
+    mot RAM[TAILLE_RAM]; // 0 hors du programme
+    int chargement;
+    int taille;
+    int depart;
+    bool binaire;
+} image_programme;
+
+// lit chemin (texte chargé à chargement, ou image binaire), via le cache
+// renvoie NULL en cas d'erreur (errno)
+const image_programme* charger_image(const char* chemin, int chargement);
+
+// programme texte de n bytes en mémoire (texte d'une requête), chargé à
+// chargement, via le cache; NULL si l'adresse est invalide (errno)
+const image_programme* charger_texte(const char* texte, size_t n, int chargement);
+
+// analyse un programme texte de n bytes, renvoie le nombre de mots chargés
+int analyser_texte(const char* texte, size_t n, mot* RAM, int chargement);
+
+// écrit le programme en image binaire, false si erreur (errno)
+bool ecrire_image(const char* chemin, const image_programme* im);
+
+// l'adresse de départ convient-elle au programme ? NULL si oui,
+// sinon le message d'erreur
+const char* valider_depart(const image_programme* im, int depart);
+
+#endif
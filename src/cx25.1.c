@@ -13,27 +13,92 @@
  *                 "make" dans le répertoire courant du dossier.
  *
  * Usage         : ./cx25.1 [programme].txt 0x[adresse_début] -stepper -ram
- *                 -journal -print -breakpoint
+ *                 -journal -print -breakpoint -quiet -balayage N -budget N
+ *                 -trace -intervalle N -image [fichier] -break ADR[,acc=V]
+ *                 [,passage=N] -watch ADR -rwatch ADR -wwatch ADR
+ *                 -points [fichier] -profile -avance -compile [fichier].c
  *
  * Description   : Le programme est écrit en C. C'est un émulateur simplifié
  *                 qui lit un programme pris en entrée et exécute les
  *                 instructions. La mémoire de 256 bytes est représentée
  *                 par un tableau RAM[]. On utilise comme registres: le PC
- *                 et l'accumulateur.
+ *                 et l'accumulateur. La taille de la mémoire et la
+ *                 largeur des adresses et de l'accumulateur se choisissent
+ *                 à la compilation (machine.h, make MACHINE="-D...").
  *                 Un débogueur est intégré au programme. Il dispose des
  *                 fonctionnalités suivante:
  *                      -ram : pour afficher l'initilisation de la RAM[];
  *                      -stepper : pour attendre une entrée utilisateur
  *                                 avant le passage à chaque instruction
- *                                 suivante (est réversible);
+ *                                 suivante (est réversible). Le stepper
+ *                                 remonte aussi le temps: 'back N',
+ *                                 'goto N' (avant le cycle n°N) et
+ *                                 'reverse-continue' (dernier passage
+ *                                 par le point d'arrêt);
+ *                      -intervalle N : cycles entre deux instantanés
+ *                                      du stepper (1024 par défaut);
+ *                      -image fichier : écrit le programme chargé en
+ *                                       image binaire (adresses de
+ *                                       chargement et de départ dans
+ *                                       l'en-tête) et s'arrête.
+ *                      -compile fichier.c : traduit le programme en C
+ *                                           (traduction.c) et s'arrête;
+ *                                           "make fichier" le compile
+ *                                           si fichier finit par _natif.
  *                      -print : pour afficher le détail
  *                               des cycles opératoires (est réversible
  *                               quand utilisé avec stepper);
  *                      -journal : pour imprimer dans un fichier journal
  *                                 le détail des cycles opératoires
+ *                      -trace : même détail, en binaire (16 bytes par
+ *                               cycle, écrit par un thread): le journal
+ *                               se régénère avec ./cx25_trace.
  *                      -breakpoint : pour mettre un point d'arrêt à une adresse
  *                                    hex du programme. S'arrêtera à chaque
  *                                    fois que l'adresse est utilisée.
+ *                      -break ADR : point d'arrêt sur l'instruction en
+ *                                   ADR (se répète); conditions
+ *                                   facultatives ',acc=V' (valeur de
+ *                                   l'accumulateur) et ',passage=N'
+ *                                   (à partir du N-ième passage);
+ *                      -watch / -rwatch / -wwatch ADR : arrêt avant une
+ *                                   instruction qui lit ou écrit /
+ *                                   lit / écrit RAM[ADR];
+ *                      -points fichier : mêmes commandes, une par ligne
+ *                                        ('break 3A acc=05', 'watch 80',
+ *                                        ...), aussi tapées au stepper.
+ *                      -profile : compte les exécutions par adresse et
+ *                                 par opcode, les branchements pris,
+ *                                 les lectures / écritures de RAM[] et
+ *                                 les boucles chaudes; écrit un rapport
+ *                                 JSON et des piles repliées (flame
+ *                                 graph) à la fin de l'exécution.
+ *                      -quiet : exécution sans trace des instructions,
+ *                               seul le résultat de OUT est affiché.
+ *                      -avance : avec -quiet, saute d'un coup les boucles
+ *                                de comptage (avance.c) et arrête une
+ *                                boucle infinie prouvée (état répété).
+ *                      -balayage N : exécute le programme pour toutes les
+ *                                    valeurs des N premières entrées de
+ *                                    IN@ (N = 1 à 3), 16 machines à la
+ *                                    fois dans des registres vectoriels.
+ *                      -budget N : cycles maximum de chaque machine lors
+ *                                  du balayage (1000000 par défaut).
+ *
+ *                 La boucle de l'émulateur est spécialisée à la compilation
+ *                 pour chaque combinaison d'options (trace, print, journal,
+ *                 stepper, breakpoint, trace binaire): une option éteinte
+ *                 ne coûte rien.
+ *                 Sans aucune option active (-quiet seul), le programme
+ *                 tourne dans l'interpréteur prédécodé (predecode.c).
+ *                 Les points d'arrêt sont des tableaux de TAILLE_RAM bits
+ *                 (points.c): un test de bit par cycle, quel que soit
+ *                 leur nombre.
+ *
+ *                 Le programme est un fichier texte (une valeur hex par
+ *                 mot) ou une image binaire écrite avec -image
+ *                 (chargeur.c). Pour tout programme, l'adresse de début
+ *                 doit désigner une instruction du programme chargé.
  *
  * Précisions    : On utilise les extensions de GCC avec -std=gnu99 afin
  *                 d'utiliser les fonctions non-standards.
@@ -47,33 +112,65 @@
 #include <string.h>
 #include <signal.h>
 #include <stdbool.h>
-
-// codes opératoires
-enum { ADD_SHARP = 0x20, ADD_AT = 0x60, ADD_STAR_AT = 0xE0, SUB_SHARP = 0x21, SUB_AT = 0x61, SUB_STAR_AT = 0xE1, NAND_SHARP = 0x22, NAND_AT = 0x62, NAND_STAR_AT = 0xE2, LOAD_SHARP = 0x0, LOAD_AT = 0x40, LOAD_STAR_AT = 0xC0, STORE_AT = 0x48, STORE_STAR_AT = 0xC8, IN_AT = 0x49, IN_STAR_AT = 0xC9, OUT_SHARP = 0x01, OUT_AT = 0x41, OUT_STAR_AT = 0xC1, JUMP_AT = 0x10, BRN_AT = 0x11, BRZ_AT = 0x12 } mnemonique;
-
-// mémoire 256 bytes
-unsigned char RAM[256];
-
-// tableau pour affichage des mnémoniques dans les cycles
-const char* nom_mnemonique[] = { [ADD_SHARP] = "ADD#", [ADD_AT] = "ADD@", [ADD_STAR_AT] = "ADD*@", [SUB_SHARP] = "SUB#", [SUB_AT] = "SUB@", [SUB_STAR_AT] = "SUB*@", [NAND_SHARP] = "NAND#", [NAND_AT] = "NAND@", [NAND_STAR_AT] = "NAND*@", [LOAD_SHARP] = "LOAD#", [LOAD_AT] = "LOAD@", [LOAD_STAR_AT] = "LOAD*@", [STORE_AT] = "STORE@", [STORE_STAR_AT] = "STORE*@", [IN_AT] = "IN@", [IN_STAR_AT] = "IN*@", [OUT_SHARP] = "OUT#", [OUT_AT] = "OUT@", [OUT_STAR_AT] = "OUT*@", [JUMP_AT] = "JUMP@", [BRN_AT] = "BRN@", [BRZ_AT] = "BRZ@" };
-
-// prototype émulateur
-void emulation(int* PC, int* accumulateur, bool* sortie_switch);
-
-// prototype fonction stepper débogueur
-void mon_stepper(int PC, int accumulateur, bool* stepper, bool* j_print, bool* ma_ram) ;
+#include "machine.h"
+#include "voies.h"
+#include "predecode.h"
+#include "trace.h"
+#include "retour.h"
+#include "chargeur.h"
+#include "points.h"
+#include "profil.h"
+#include "avance.h"
+#include "traduction.h"
+
+// budget de cycles par défaut de chaque voie lors d'un balayage
+#define BUDGET_BALAYAGE 1000000
+
+// crochets du débogueur appelés par la boucle de l'émulateur
+enum { CROCHET_TRACE = 1, CROCHET_PRINT = 2, CROCHET_JOURNAL = 4, CROCHET_STEPPER = 8, CROCHET_BREAKPOINT = 16, CROCHET_BINAIRE = 32, CROCHET_PROFIL = 64 };
+
+// registres et options du débogueur partagés par la boucle
+typedef struct {
+    machine m; // RAM[], PC, accumulateur, compteur
+    bool silencieux; // -quiet: seul le résultat de OUT est affiché
+    bool stepper;
+    bool journal;
+    bool j_print;
+    bool ma_ram;
+    bool point_arret; // -breakpoint: adresse demandée au lancement
+    points_arret points; // tous les points d'arrêt et de surveillance
+    FILE* mon_journal;
+    bool binaire; // -trace
+    trace_binaire trace;
+    historique retour; // exécution à rebours du stepper
+    bool profiler; // -profile
+    profil_execution profil;
+    bool avance; // -avance: avance rapide et boucles infinies
+} etat_emulateur;
+
+// prototype boucle émulateur
+void lancer_emulateur(etat_emulateur* e);
+
+// prototype sélection des crochets
+static unsigned crochets_actifs(const etat_emulateur* e);
+
+// prototype fonction stepper débogueur (e = NULL à l'initialisation de la RAM)
+bool mon_stepper(int PC, int accumulateur, bool* stepper, bool* j_print, bool* ma_ram, etat_emulateur* e) ;
 
 // prtotyle journal débogueur
-void ecriture_journal(FILE* mon_journal, int compteur, int* PC, unsigned char *RAM, const char** nom_mnemonique, int accumulateur);
+void ecriture_journal(FILE* mon_journal, unsigned long compteur, int* PC, const mot* RAM, const char** nom_mnemonique, int accumulateur);
 
 // impression verbeuse émulateur débogueur
-void details_print(int compteur, int* PC, unsigned char* RAM, const char** nom_mnemonique, int accumulateur);
+void details_print(unsigned long compteur, int* PC, const mot* RAM, const char** nom_mnemonique, int accumulateur);
 
 // prototype breakpoint
-void breakpoint(bool* point_arret, int* adresse_point_arret, int PC);
+void breakpoint(etat_emulateur* e, int PC, int accumulateur, unsigned long compteur);
 
 // prototype définition breakpoint
-void def_breakpoint(int* adresse_point_arret);
+void def_breakpoint(points_arret* points);
+
+// prototype commande de point d'arrêt de la ligne de commande
+void option_point(points_arret* points, const char* commande, const char* argument);
 
 // message d'erreur sur stderr
 void usage(char* message);
@@ -82,42 +179,30 @@ void usage(char* message);
 int main(int k, char* ldc[]) {
 
     if (k<3) { // s'il manque un élément essentiel
-        usage("\nExemple d'utilisation: ./cx25.1 prog_10_5.txt 30\n\nMode d'emploi:\n\n\t- N'oubliez pas le './' pour indiquer que nous sommes dans le répertoire courant.\n\n\t-L'argument[0] est le nom du programme, ici 'cx25.1'\n\n\t-L'argument[1] est le nom du fichier à faire tourner dans l'ordinateur en papier:\n\t\t*Le fichier doit se trouver dans le répertoire courant. \n\t\t*Pensez à bien ajouter l'extension '.txt'. \n\t\t*Les fichiers pouvant être utilisés sont: \n\t\t\t- 'prog_test.txt'(qui teste l'ensemble des mnémoniques)--> début = 0x2E, \n\t\t\t- 'prog_10_5.txt'(qui affiche le produit de 2 nombres)--> début = 0x30, \n\t\t\t- 'prog_10_6.txt' (qui affiche le quotient entier de 2 nombres) --> début = 0x36, \n\t\t\t- 'prog_10_7.txt' (qui donne le cube d'un nombre) --> début = 0x50, \n\t\t\t- 'prog_13_8.txt' (qui ne fait rien - programme maintenant supprimé)--> début = 0x30.\n\n\t-L'argument[2] est l'adresse à partir de laquelle il faut lancer le fichier passé en argument: \n\t\t*L'adresse doit être HEXADÉCIMALE. \n\t\t\t- Vous pouvez ajouter (ou non) 0x avant la valeur. \n\t\t\t- La valeur entrée sera toujours interprétée comme une valeur hexédécimale.\n\n\nExemple d'utilisation du débogueur: \n./cx25.1 prog_10_5.txt 30 -ram -breakpoint -stepper -journal -print\n\nMode d'emploi du débogueur:\n\n\t- Pour afficher l'initialisation de la RAM, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-ram'\n\t\t*Cette fonctionnalité peut être utilisée en association avec le stepper.\n\n\t- Pour insérer un point d'arrêt, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-breakpoint'\n\t\t*L'utilisateur va être invité à entrer une valeur correspondant au point d'arrêt avant le lancement de l'émulateur. \n\t\t*La valeur du breakpoint doit correspondre à une adresse hexadécimale valide de RAM[]. \n\n\t- Pour utiliser le stepper, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-stepper'\n\t\t*Le stepper attend avant le passage à chaque instruction suivante du programme que l'utilisateur appuie sur la touche entrée. \n\t\t*Le stepper affiche la valeur de PC et de l'accumulateur.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\t\t*Pour activer l'impression détaillée des cycles au sein du stepper, entrez 'print'.\n\t\t*Pour désactiver l'affichage détaillé des cycles au sein du stepper, entrez 'stop_print'.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\n\t- Pour utiliser le journal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-journal'.\n\t\t*Un fichier au nom personnalisé selon le programme passé en argument 'journal_prog_[...].txt' contenant les détails de chaque cycle d'opération sera créé.\n\n\t- Pour afficher les cycles détaillés (à l'identique du journal) dans le terminal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-print'.\n\t\t*Les cycles détaillés peuvent être activés depuis le stepper avec l'option 'print'.\n\t\t*Les cycles détaillés peuvent être désactivés depuis le stepper avec l'option 'stop_print'.\n\n");}
-
-    else if (strcmp(ldc[1], "prog_test.txt") == 0){
-        if (!(strcmp(ldc[2], "0x2E") == 0 || strcmp(ldc[2], "2E") == 0)) {
-        usage("Veuillez entrer pour adresse héxadécimale de début du programme prog_test.txt soit '0x2E' soit '2E'. Sinon, le programme ne s'exécutera pas correctement");}}
-
-    else if (strcmp(ldc[1], "prog_10_5.txt") == 0){
-        if (!(strcmp(ldc[2], "0x30") == 0 || strcmp(ldc[2], "30") == 0)) {
-        usage("Veuillez entrer pour adresse héxadécimale de début du programme 10_5.txt soit '30' soit '0x30'. Sinon, le programme ne s'exécutera pas correctement");}}
-
-    else if (strcmp(ldc[1], "prog_10_6.txt") == 0){
-        if (!(strcmp(ldc[2], "0x36") == 0 || strcmp(ldc[2], "36") == 0)) {
-        usage("Veuillez entrer pour adresse héxadécimale de début du programme 10_6.txt soit '36' soit '0x36'. Sinon, le programme ne s'exécutera pas correctement");}}
+        usage("\nExemple d'utilisation: ./cx25.1 prog_10_5.txt 30\n\nMode d'emploi:\n\n\t- N'oubliez pas le './' pour indiquer que nous sommes dans le répertoire courant.\n\n\t-L'argument[0] est le nom du programme, ici 'cx25.1'\n\n\t-L'argument[1] est le nom du fichier à faire tourner dans l'ordinateur en papier:\n\t\t*Le fichier doit se trouver dans le répertoire courant. \n\t\t*Pensez à bien ajouter l'extension '.txt'. \n\t\t*Les fichiers pouvant être utilisés sont: \n\t\t\t- 'prog_test.txt'(qui teste l'ensemble des mnémoniques)--> début = 0x2E, \n\t\t\t- 'prog_10_5.txt'(qui affiche le produit de 2 nombres)--> début = 0x30, \n\t\t\t- 'prog_10_6.txt' (qui affiche le quotient entier de 2 nombres) --> début = 0x36, \n\t\t\t- 'prog_10_7.txt' (qui donne le cube d'un nombre) --> début = 0x50, \n\t\t\t- 'prog_13_8.txt' (qui ne fait rien - programme maintenant supprimé)--> début = 0x30.\n\n\t-L'argument[2] est l'adresse à partir de laquelle il faut lancer le fichier passé en argument: \n\t\t*L'adresse doit être HEXADÉCIMALE. \n\t\t\t- Vous pouvez ajouter (ou non) 0x avant la valeur. \n\t\t\t- La valeur entrée sera toujours interprétée comme une valeur hexédécimale.\n\n\nExemple d'utilisation du débogueur: \n./cx25.1 prog_10_5.txt 30 -ram -breakpoint -stepper -journal -print\n\nMode d'emploi du débogueur:\n\n\t- Pour afficher l'initialisation de la RAM, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-ram'\n\t\t*Cette fonctionnalité peut être utilisée en association avec le stepper.\n\n\t- Pour insérer un point d'arrêt, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-breakpoint'\n\t\t*L'utilisateur va être invité à entrer une valeur correspondant au point d'arrêt avant le lancement de l'émulateur. \n\t\t*La valeur du breakpoint doit correspondre à une adresse hexadécimale valide de RAM[]. \n\n\t- Pour plusieurs points d'arrêt, des conditions ou la surveillance de la RAM, passez '-break ADR[,acc=V][,passage=N]', '-watch ADR', '-rwatch ADR', '-wwatch ADR' ou '-points fichier' (une commande 'break', 'watch', 'rwatch', 'wwatch' ou 'delete' par ligne).\n\n\t- Pour utiliser le stepper, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-stepper'\n\t\t*Le stepper attend avant le passage à chaque instruction suivante du programme que l'utilisateur appuie sur la touche entrée. \n\t\t*Le stepper affiche la valeur de PC et de l'accumulateur.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\t\t*Pour activer l'impression détaillée des cycles au sein du stepper, entrez 'print'.\n\t\t*Pour désactiver l'affichage détaillé des cycles au sein du stepper, entrez 'stop_print'.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\n\t- Pour utiliser le journal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-journal'.\n\t\t*Un fichier au nom personnalisé selon le programme passé en argument 'journal_prog_[...].txt' contenant les détails de chaque cycle d'opération sera créé.\n\n\t- Pour afficher les cycles détaillés (à l'identique du journal) dans le terminal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-print'.\n\t\t*Les cycles détaillés peuvent être activés depuis le stepper avec l'option 'print'.\n\t\t*Les cycles détaillés peuvent être désactivés depuis le stepper avec l'option 'stop_print'.\n\n");}
 
-    else if (strcmp(ldc[1], "prog_10_7.txt") == 0){
-        if (!(strcmp(ldc[2], "0x30") == 0 || strcmp(ldc[2], "30") == 0)) {
-        usage("Veuillez entrer pour adresse héxadécimale de début du programme 10_7.txt soit '50' soit '0x50'. Sinon, le programme ne s'exécutera pas correctement");}}
-
-    else if (strcmp(ldc[1], "prog_13_8.txt") == 0){
-        if (!(strcmp(ldc[2], "0x30") == 0 || strcmp(ldc[2], "30") == 0)) {
-        usage("Veuillez entrer pour adresse héxadécimale de début du programme 13_8.txt soit '30' soit '0x30'. Sinon, le programme ne s'exécutera pas correctement");}}
-
-    if (k==3) { // si aucune option du débogueur n'est utilisée
-        printf("\nExemple d'utilisation du débogueur: \n./cx25.1 prog_10_5.txt 30 -ram -breakpoint -stepper -journal -print\n\nMode d'emploi du débogueur:\n\n\t- Pour afficher l'initialisation de la RAM, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-ram'\n\t\t*Cette fonctionnalité peut être utilisée en association avec le stepper.\n\n\t- Pour insérer un point d'arrêt, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-breakpoint'\n\t\t*L'utilisateur va être invité à entrer une valeur correspondant au point d'arrêt avant le lancement de l'émulateur. \n\t\t*La valeur du breakpoint doit correspondre à une adresse hexadécimale valide de RAM[]. \n\n\t- Pour utiliser le stepper, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-stepper'\n\t\t*Le stepper attend avant le passage à chaque instruction suivante du programme que l'utilisateur appuie sur la touche entrée. \n\t\t*Le stepper affiche la valeur de PC et de l'accumulateur.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\t\t*Pour activer l'impression détaillée des cycles au sein du stepper, entrez 'print'.\n\t\t*Pour désactiver l'affichage détaillé des cycles au sein du stepper, entrez 'stop_print'.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\n\t- Pour utiliser le journal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-journal'.\n\t\t*Un fichier 'journal.txt' contenant les détails de chaque cycle d'opération sera créé.\n\n\t- Pour afficher les cycles détaillés (sur le modèle du journal) dans le terminal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-print'.\n\t\t*Les cycles détaillés peuvent être activés depuis le stepper avec l'option ' print'.\n\t\t*Les cycles détaillés peuvent être désactivés depuis le stepper avec l'option 'stop_print'.\n\n");}
 
     char chemin_programme[1024];
-    strcpy(chemin_programme, "./"); // répertoire courant, pas obligatoire
-    strcat(chemin_programme, ldc[1]); // + ajout nom fichier
+    snprintf(chemin_programme, sizeof(chemin_programme), "%s%s", (ldc[1][0] == '/') ? "" : "./", ldc[1]); // répertoire courant, pas obligatoire
 
-    int debut = strtol(ldc[2], NULL, 16); // adresse de départ en héxadécimale
+    char* fin_adresse;
+    int debut = strtol(ldc[2], &fin_adresse, 16); // adresse de départ en héxadécimale
+    if ((fin_adresse == ldc[2]) || (*fin_adresse != '\0')) {
+        usage("Veuillez entrer pour adresse de début une valeur hexadécimale (par exemple '30' ou '0x30').");}
 
-    FILE* programme = fopen(chemin_programme, "r") ; // programme à exécuter
+    // programme texte ou image binaire, analysé une seule fois
+    const image_programme* programme = charger_image(chemin_programme, debut);
     if (! programme){
         perror("fichier programme (main)");
         exit(EXIT_FAILURE);}
 
+    // l'adresse de début doit tomber sur une instruction du programme
+    const char* erreur_depart = valider_depart(programme, debut);
+    if (erreur_depart) {usage((char*) erreur_depart);}
+
+    if (k==3) { // si aucune option du débogueur n'est utilisée
+        printf("\nExemple d'utilisation du débogueur: \n./cx25.1 prog_10_5.txt 30 -ram -breakpoint -stepper -journal -print\n\nMode d'emploi du débogueur:\n\n\t- Pour afficher l'initialisation de la RAM, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-ram'\n\t\t*Cette fonctionnalité peut être utilisée en association avec le stepper.\n\n\t- Pour insérer un point d'arrêt, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-breakpoint'\n\t\t*L'utilisateur va être invité à entrer une valeur correspondant au point d'arrêt avant le lancement de l'émulateur. \n\t\t*La valeur du breakpoint doit correspondre à une adresse hexadécimale valide de RAM[]. \n\n\t- Pour plusieurs points d'arrêt, des conditions ou la surveillance de la RAM, passez '-break ADR[,acc=V][,passage=N]', '-watch ADR', '-rwatch ADR', '-wwatch ADR' ou '-points fichier' (une commande 'break', 'watch', 'rwatch', 'wwatch' ou 'delete' par ligne).\n\n\t- Pour utiliser le stepper, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-stepper'\n\t\t*Le stepper attend avant le passage à chaque instruction suivante du programme que l'utilisateur appuie sur la touche entrée. \n\t\t*Le stepper affiche la valeur de PC et de l'accumulateur.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\t\t*Pour activer l'impression détaillée des cycles au sein du stepper, entrez 'print'.\n\t\t*Pour désactiver l'affichage détaillé des cycles au sein du stepper, entrez 'stop_print'.\n\t\t*Pour sortir du stepper, entrez 'stop_stepper'.\n\n\t- Pour utiliser le journal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-journal'.\n\t\t*Un fichier 'journal.txt' contenant les détails de chaque cycle d'opération sera créé.\n\n\t- Pour afficher les cycles détaillés (sur le modèle du journal) dans le terminal, passez un argument (dans l'ordre que vous voulez mais après l'argument[2]) '-print'.\n\t\t*Les cycles détaillés peuvent être activés depuis le stepper avec l'option ' print'.\n\t\t*Les cycles détaillés peuvent être désactivés depuis le stepper avec l'option 'stop_print'.\n\n");}
+
     FILE* mon_journal = NULL;
     int i;
     bool stepper = false; // initialisation valeur stepper
@@ -125,6 +210,17 @@ int main(int k, char* ldc[]) {
     bool j_print = false; // impression verbeuse
     bool ma_ram = false; // impression RAM
     bool point_arret = false; // point d'arrêt
+    bool silencieux = false; // sans trace des instructions
+    int balayage = 0; // nombre d'entrées de IN@ à balayer
+    unsigned long budget = 0; // cycles maximum, 0 = illimité
+    bool binaire = false; // trace binaire
+    unsigned long intervalle = INTERVALLE_INSTANTANES; // instantanés du stepper
+    const char* nom_image = NULL; // image binaire à écrire
+    const char* nom_traduction = NULL; // programme C à écrire
+    static points_arret points; // -break, -watch, ... et -points (hors de la pile)
+    bool profiler = false; // profil d'exécution
+    bool avance = false; // avance rapide des boucles
+    points_init(&points);
 
     for (i=0; i < k; i++){ // si ___ en argument ldc
 
@@ -133,7 +229,24 @@ int main(int k, char* ldc[]) {
         if (strcasecmp(ldc[i], "-journal") == 0) {journal = true;}
         if (strcasecmp(ldc[i], "-print") == 0) {j_print = true;}
         if (strcasecmp(ldc[i], "-ram") == 0) {ma_ram = true;}
-        if (strcasecmp(ldc[i], "-breakpoint") == 0) {point_arret = true;}}
+        if (strcasecmp(ldc[i], "-breakpoint") == 0) {point_arret = true;}
+        if (strcasecmp(ldc[i], "-quiet") == 0) {silencieux = true;}
+        if (strcasecmp(ldc[i], "-trace") == 0) {binaire = true;}
+        if (strcasecmp(ldc[i], "-profile") == 0) {profiler = true;}
+        if (strcasecmp(ldc[i], "-avance") == 0) {avance = true;}
+        if ((strcasecmp(ldc[i], "-balayage") == 0) && (i+1 < k)) {balayage = atoi(ldc[i+1]);}
+        if ((strcasecmp(ldc[i], "-budget") == 0) && (i+1 < k)) {budget = strtoul(ldc[i+1], NULL, 0);}
+        if ((strcasecmp(ldc[i], "-intervalle") == 0) && (i+1 < k)) {intervalle = strtoul(ldc[i+1], NULL, 0);}
+        if ((strcasecmp(ldc[i], "-image") == 0) && (i+1 < k)) {nom_image = ldc[i+1];}
+        if ((strcasecmp(ldc[i], "-compile") == 0) && (i+1 < k)) {nom_traduction = ldc[i+1];}
+        if ((strcasecmp(ldc[i], "-break") == 0) && (i+1 < k)) {option_point(&points, "break", ldc[i+1]);}
+        if ((strcasecmp(ldc[i], "-watch") == 0) && (i+1 < k)) {option_point(&points, "watch", ldc[i+1]);}
+        if ((strcasecmp(ldc[i], "-rwatch") == 0) && (i+1 < k)) {option_point(&points, "rwatch", ldc[i+1]);}
+        if ((strcasecmp(ldc[i], "-wwatch") == 0) && (i+1 < k)) {option_point(&points, "wwatch", ldc[i+1]);}
+        if ((strcasecmp(ldc[i], "-points") == 0) && (i+1 < k) && (!points_fichier(&points, ldc[i+1]))) {exit(EXIT_FAILURE);}}
+
+    if ((balayage < 0) || (balayage > 3)) {
+        usage("Le balayage porte sur 1, 2 ou 3 entrées de IN@.");}
 
     char nom_journal[100];
 
@@ -146,234 +259,309 @@ int main(int k, char* ldc[]) {
         perror("fichier journal (main)");
         exit(EXIT_FAILURE);}
 
-    int PC = 0x0; // initialisation registres pour RAM
-    int accumulateur = 0x0;
-    int compteur = 0;
+    static etat_emulateur e; // RAM[], points et profil: hors de la pile
+    e.silencieux = silencieux; e.stepper = stepper;
+    e.journal = journal; e.j_print = j_print; e.ma_ram = ma_ram;
+    e.point_arret = point_arret; e.points = points;
+    e.mon_journal = mon_journal; e.binaire = binaire; e.profiler = profiler; e.avance = avance;
+    static const mot image[TAILLE_RAM];
+    machine_init(&e.m, image, 0x0); // initialisation registres pour RAM
 
     // initilisation de la RAM[]
-    int num, h = debut;
+    int h;
 
-    while (fscanf(programme, "%x", &num) == 1) {
-        RAM[h] = (unsigned char) num;
+    for (h = programme->chargement; h < programme->chargement + programme->taille; h++) {
+        e.m.RAM[h] = programme->RAM[h];
 
         // si option -ram du débogueur activée
-        if (ma_ram) printf("\tRAM[0x%02x] = 0x%02x\n", h, RAM[h]);
+        if (e.ma_ram) printf("\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n", h, e.m.RAM[h]);
         // si option -stepper & option -ram du débogueur activés
-        if ((ma_ram)&&(stepper)) {mon_stepper(PC, accumulateur, &stepper, &j_print, &ma_ram);}
-        h++;}
-
-    if (ferror(programme)) { // gestion des erreurs
-        perror("Erreur lors de la lecture du fichier programme à l'initialisation de la RAM");
-        exit(EXIT_FAILURE);}
+        if ((e.ma_ram)&&(e.stepper)) {mon_stepper(e.m.PC, e.m.accumulateur, &e.stepper, &e.j_print, &e.ma_ram, NULL);}}
+
+    // ssi image en arg, on écrit le programme en image binaire et on s'arrête
+    if (nom_image) {
+        if (!ecrire_image(nom_image, programme)) {
+            perror("fichier image (main)");
+            exit(EXIT_FAILURE);}
+        if (journal) fclose(mon_journal);
+        return 0;}
+
+    // ssi compile en arg, on traduit le programme en C et on s'arrête
+    if (nom_traduction) {
+        FILE* traduction = fopen(nom_traduction, "w");
+        if ((!traduction) || (!traduire_programme(traduction, e.m.RAM, debut, ldc[1])) || (fclose(traduction) != 0)) {
+            perror("fichier de traduction (main)");
+            exit(EXIT_FAILURE);}
+        if (journal) fclose(mon_journal);
+        return 0;}
+
+    e.m.PC = debut; // initialisation registres pour émulateur
+
+    // balayage de toutes les valeurs des entrées, machines en parallèle
+    if (balayage) {
+        balayer_entrees(e.m.RAM, debut, balayage, budget ? budget : BUDGET_BALAYAGE, stdout);
+        if (journal) fclose(mon_journal);
+        return 0;}
+
+    // ssi trace en arg, fichier binaire personnalisé + thread d'écriture
+    if (binaire) {
+        char nom_trace[300];
+        snprintf(nom_trace, sizeof(nom_trace), "trace_cx25.1_%s.bin", ldc[1]);
+        if (!trace_ouvrir(&e.trace, nom_trace)) {
+            perror("fichier trace (main)");
+            exit(EXIT_FAILURE);}}
+
+    if (profiler) profil_init(&e.profil);
+
+    // le stepper garde de quoi remonter le temps
+    if (e.stepper) historique_init(&e.retour, intervalle);
 
+    // utilisateur entre le point d'arrêté souhaité
+    if (e.point_arret){def_breakpoint(&e.points);}
 
-    PC = debut; // initialisation registres pour émulateur
-    bool sortie_switch = false; // pour sortir switch quand "OUT"
-    int adresse_point_arret; // pour breakpoint
+    // boucle de l'émulateur (spécialisée selon les options)
+    lancer_emulateur(&e);
 
-    // utilisateur entre le point d'arrêté souhaité
-    if (point_arret){def_breakpoint(&adresse_point_arret);}
+    // sans trace, seul le résultat de OUT est affiché
+    if ((e.silencieux) && (e.m.raison == ARRET_OUT)) printf("0x" HEX_MOT "\n", e.m.resultat);
+    if (e.m.raison == ARRET_BOUCLE) printf("Boucle infinie: l'état de la machine se répète (PC = 0x" HEX_ADRESSE ", cycle n°%lu).\n", e.m.PC, e.m.compteur);
 
-        // boucle de l'émulateur
-    while ((PC > 0x1F) && (PC < 0xFF)){ // dispo mémoire entre 16 et 254 (base 10)
-        compteur ++;
+    if ((journal) && (fclose(mon_journal) != 0)) { // ssi le fichier a été créé
+    perror("Erreur lors de la fermeture du fichier mon_journal");
+    exit(EXIT_FAILURE);}
 
-        // si option -breakpoint du débogueur
-        breakpoint(&point_arret, &adresse_point_arret, PC);
+    if ((binaire) && (!trace_fermer(&e.trace))) {
+    perror("Erreur lors de l'écriture du fichier trace");
+    exit(EXIT_FAILURE);}
 
-        // si option -journal du débogueur
-        if (journal) {ecriture_journal(mon_journal, compteur, &PC, &RAM[0], &nom_mnemonique[0], accumulateur);}
+    // ssi profile en arg, rapport JSON + piles repliées personnalisés
+    if (profiler) {
+        char nom_json[300], nom_piles[300];
+        snprintf(nom_json, sizeof(nom_json), "profil_cx25.1_%s.json", ldc[1]);
+        snprintf(nom_piles, sizeof(nom_piles), "profil_cx25.1_%s.folded", ldc[1]);
+        profil_solder(&e.profil); // compteurs de l'interpréteur prédécodé
+        if (!profil_ecrire(&e.profil, &e.m, ldc[1], nom_json, nom_piles)) {
+            perror("Erreur lors de l'écriture du profil");
+            exit(EXIT_FAILURE);}}
+
+    if (stepper) historique_liberer(&e.retour);
+    return 0; }
 
-        // si option -print du débogueur
-        if (j_print) {details_print(compteur, &PC, &RAM[0], &nom_mnemonique[0], accumulateur);}
 
-        // si option -stepper du débogueur
-        if (stepper) {mon_stepper(PC, accumulateur, &stepper, &j_print, &ma_ram);}
+// boucle de l'émulateur, spécialisée à la compilation pour chaque
+// combinaison de crochets: les options éteintes n'y laissent aucun test
+// renvoie false quand le stepper a changé les options (re-sélection)
+static inline __attribute__((always_inline)) bool boucle_emulateur(etat_emulateur* e, const unsigned crochets){
 
-        // coeur du programme émulateur
-        emulation(&PC, &accumulateur, &sortie_switch);
-        //on sort du switch quand "OUT"
-        if (sortie_switch){break;}        }
+    machine* m = &e->m;
+    int PC = m->PC, accumulateur = m->accumulateur;
+    unsigned long compteur = m->compteur;
+    bool a_jour = true;
 
-    if (fclose(programme) != 0) {
-    perror("Erreur lors de la fermeture du fichier programme");
-    exit(EXIT_FAILURE);}
+    while (PC_VALIDE(PC)){ // dispo mémoire entre 16 et 254 (base 10)
+        compteur ++;
 
-    if ((journal) && (fclose(mon_journal) != 0)) { // ssi le fichier a été créé
-    perror("Erreur lors de la fermeture du fichier mon_journal");
-    exit(EXIT_FAILURE);}
-    return 0; }
+        // si un point d'arrêt est armé: un test de bit, le reste hors boucle
+        if ((crochets & CROCHET_BREAKPOINT) && (points_touche(&e->points, PC, &m->RAM[0]))) {breakpoint(e, PC, accumulateur, compteur);}
 
+        // si option -print du débogueur
+        if (crochets & CROCHET_PRINT) {details_print(compteur, &PC, &m->RAM[0], &nom_mnemonique[0], accumulateur);}
 
-// fonctionnement de l'ordinateur en papier
-void emulation(int* PC, int* accumulateur, bool* sortie_switch){
-
-            switch (RAM[*PC]){
-
-            case ADD_SHARP://ADD# ajoute l'entier immédiat à acc
-            *accumulateur += RAM[*PC+1];
-            printf("\tADD# 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case ADD_AT://ADD@ ajoute la valeur de l'adresse spécifiée à acc
-            *accumulateur += RAM[RAM[*PC+1]];
-            printf("\tADD@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case ADD_STAR_AT: //ADD*@ ajoute la valeur d'un ptr de ptr à acc
-            *accumulateur += RAM[RAM[RAM[*PC+1]]];
-            printf("\tADD*@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case SUB_SHARP://SUB# soustrait entier immédiat
-            *accumulateur -= RAM[*PC+1];
-            printf("\tSUB# 0x%02x\n\tPC = [0x%02x]\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *PC, *accumulateur); *PC +=2; break;
-
-            case SUB_AT://SUB@ soustrait la valeur de l'adresse spécifiée
-            *accumulateur -= RAM[RAM[*PC+1]];
-            printf("\tSUB@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case SUB_STAR_AT://SUB*@ soustrait la valeur via ptr de ptr
-            *accumulateur -= RAM[RAM[RAM[*PC+1]]];
-            printf("\tSUB*@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case NAND_SHARP://NAND# bit à bit avec entier immédiat
-            *accumulateur = ~(*accumulateur & RAM[*PC+1]);
-            printf("\tNAND# 0x%02x\n\n\n", RAM[*PC+1]);*PC +=2;break;
-
-            case NAND_AT://NAND@ bit à bit avec valeur de l'ad. spécifiée
-            *accumulateur = ~(*accumulateur & RAM[RAM[*PC+1]]);
-            printf("\tNAND@ 0x%02x\n\n\n", RAM[*PC+1]);*PC +=2;break;
-
-            case NAND_STAR_AT://NAND*@ bit à bit via ptr de ptr
-            *accumulateur = ~(*accumulateur & RAM[RAM[RAM[*PC+1]]]);
-            printf("\tNAND*@ 0x%02x\n\n\n", RAM[*PC+1]);*PC +=2;break;
-
-            case LOAD_SHARP://LOAD# charge entier immédiat
-            *accumulateur = RAM[*PC+1];
-            printf("\tLOAD# 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case LOAD_AT://LOAD@ charge entier d'ad. mémoire
-            *accumulateur = RAM[RAM[*PC+1]];
-            printf("\tLOAD@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2;break;
-
-            case LOAD_STAR_AT://LOAD*@ charge entier via ptr de ptr
-            *accumulateur = RAM[RAM[RAM[*PC+1]]];
-            printf("\tLOAD*@ 0x%02x\n\tAccumulateur = 0x%02x\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
-
-            case STORE_AT://STORE@ stocke acc. dans ad. mémoire
-            RAM[RAM[*PC+1]] = *accumulateur;
-            printf("\tSTORE@ 0x%02x\n\n\n", RAM[*PC+1]);*PC +=2;break;
-
-            case STORE_STAR_AT://STORE*@ stocke acc. dans ptr de ptr
-            printf("\n"); RAM[RAM[RAM[*PC+1]]] = *accumulateur;
-            printf("\tSTORE*@ 0x%02x\n\n\n", RAM[*PC+1]); *PC +=2; break;
-
-            case IN_AT://IN@ lit entrée user et la stocke dans ad. mémoire
-            printf("\tIN@ 0x%02x",RAM[*PC+1]);
-            printf("\n\tEntrez une valeur hexadécimale:");
-            if (scanf("%hhx", &RAM[RAM[*PC+1]]) != 1) {
-                perror("Erreur lors de la saisie de la valeur hexadécimale");
-                exit(EXIT_FAILURE); }
-            printf("\n");
-            while(getchar() != '\n'); // vide buffer pour stepper
-            printf("\tValeur entrée: 0x%02x\n\n\n", RAM[RAM[*PC+1]]);*PC +=2; break;
-
-            case IN_STAR_AT://IN*@ lit entrée user et la stocke dans ptr de ptr
-            printf("\tIN*@ 0x%02x\n\tEntrez une valeur hexadécimale:",RAM[*PC+1]);
-            //if (scanf("%hhx", &RAM[RAM[RAM[*PC+1]]]) != 1) {
-                //perror("Erreur lors de la saisie de la valeur hexadécimale");
-                //exit(EXIT_FAILURE);}
-            while(getchar() != '\n'); // vide buffer pour stepper
-            printf("\tValeur entrée: 0x%02x\n\n\n", RAM[RAM[RAM[*PC+1]]]);*PC +=2; break;
-
-            case OUT_SHARP: //OUT# affiche résultat immédiat en sortie
-            printf("\tOUT# 0x%02x\n\tLe résultat est: 0x%02x\n\n\n",RAM[*PC+1], RAM[*PC+1]);
-            *sortie_switch = true; break;
-
-            case OUT_AT://OUT@ affiche résultat à une ad. mémoire sur la sortie
-            printf("\tOUT@ 0x%02x\n\tLe résultat est: 0x%02x\n\n\n",RAM[*PC+1], RAM[RAM[*PC+1]]);
-            *sortie_switch = true; break;
-
-            case OUT_STAR_AT://OUT*@ affiche un résultat pointé par un ptr de ptr
-            printf("\tOUT*@ 0x%02x\n\tLe résultat est: 0x%02x\n\n\n",RAM[*PC+1], RAM[RAM[RAM[*PC+1]]]);
-            *sortie_switch = true; *PC +=2; break;
-
-            case JUMP_AT://JUMP@ saut inconditionnel vers ad. mémoire
-            printf("\tJUMP@ 0x%02x\n\n\n", RAM[*PC+1]);
-            *PC = RAM[*PC+1]; break;
-
-            case BRN_AT://BRN@ saut conditionnel si acc <0
-            printf("\tBRN@ 0x%02x\n\tAccumulateur = 0x%02x\n\tSi l'accumulateur < 0, PC <- [0x%02x]\n\n\n",RAM[*PC+1], *accumulateur, RAM[*PC+1]);
-            if (*accumulateur & 0x80) // vérifie si le bit est de signe 1
-                *PC = RAM[*PC+1];
-            else *PC+=2;
-            break;
-
-            case BRZ_AT://BRZ@ saut conditionnel si acc = 0
-            printf("\tBRZ_AT 0x%02x\n\tAccumulateur = 0x%02x\n\tSi l'accumulateur = 0, PC <- [0x%02x]\n\n\n",RAM[*PC+1], *accumulateur, RAM[*PC+1]);
-            if (*accumulateur == 0)
-                *PC = RAM[*PC+1];
-            else *PC+=2;
-            break;
-
-            default:
-            printf("Instruction non reconnue : %d\n", RAM[*PC]);
-            break;}}
+        // si option -stepper du débogueur
+        if (crochets & CROCHET_STEPPER) {
+            m->PC = PC; m->accumulateur = accumulateur; m->compteur = compteur - 1;
+            bool deplace = mon_stepper(PC, accumulateur, &e->stepper, &e->j_print, &e->ma_ram, e);
+            a_jour = (crochets_actifs(e) == crochets);
+
+            // retour dans le temps: on reprend au cycle atteint
+            if (deplace){
+                PC = m->PC; accumulateur = m->accumulateur; compteur = m->compteur;
+                if (!a_jour) {break;}
+                continue;}
+            historique_avant(&e->retour, m);}
+
+        // si option -journal du débogueur (après un éventuel retour: le
+        // journal et la trace ne gardent que les cycles exécutés)
+        if (crochets & CROCHET_JOURNAL) {ecriture_journal(e->mon_journal, compteur, &PC, &m->RAM[0], &nom_mnemonique[0], accumulateur);}
+
+        // si option -trace: enregistrement binaire
+        enregistrement_trace* r = NULL;
+        if (crochets & CROCHET_BINAIRE) {r = trace_cycle(&e->trace, compteur, PC, &m->RAM[0], accumulateur);}
+
+        // si option -profile: compteurs du cycle (après un éventuel retour)
+        if (crochets & CROCHET_PROFIL) {profil_cycle(&e->profil, PC, &m->RAM[0], accumulateur);}
+
+        // coeur du programme émulateur, on sort du switch quand "OUT"
+        bool arret = executer_instruction(m, &PC, &accumulateur, crochets & CROCHET_TRACE);
+        if (crochets & CROCHET_BINAIRE) {trace_ecriture(r, &m->RAM[0]);}
+        if (crochets & CROCHET_STEPPER) {
+            historique_apres(&e->retour, m);
+            // stepper arrêté: les IN@ suivants lisent de nouveau le clavier
+            if (!e->stepper) m->entrees_tampon = false;}
+        if (arret){break;}
+        // le stepper a modifié les options: on change de spécialisation
+        if ((crochets & CROCHET_STEPPER) && !a_jour){break;}}
+
+    if (!PC_VALIDE(PC)) m->raison = ARRET_PC;
+    m->PC = PC; m->accumulateur = accumulateur; m->compteur = compteur;
+    return a_jour;}
+
+
+// combinaison des crochets actifs selon les options du débogueur
+static unsigned crochets_actifs(const etat_emulateur* e){
+    return (e->silencieux ? 0 : CROCHET_TRACE) | (e->j_print ? CROCHET_PRINT : 0)
+        | (e->journal ? CROCHET_JOURNAL : 0) | (e->stepper ? CROCHET_STEPPER : 0)
+        | (e->points.nb ? CROCHET_BREAKPOINT : 0) | (e->binaire ? CROCHET_BINAIRE : 0)
+        | (e->profiler ? CROCHET_PROFIL : 0);}
+
+
+// une instance de la boucle par combinaison (constante connue du compilateur)
+#define CAS_BOUCLE(n) case (n): return boucle_emulateur(e, (n));
+#define CAS_BOUCLE2(n) CAS_BOUCLE(n) CAS_BOUCLE((n)+1)
+#define CAS_BOUCLE4(n) CAS_BOUCLE2(n) CAS_BOUCLE2((n)+2)
+#define CAS_BOUCLE8(n) CAS_BOUCLE4(n) CAS_BOUCLE4((n)+4)
+#define CAS_BOUCLE16(n) CAS_BOUCLE8(n) CAS_BOUCLE8((n)+8)
+#define CAS_BOUCLE32(n) CAS_BOUCLE16(n) CAS_BOUCLE16((n)+16)
+#define CAS_BOUCLE64(n) CAS_BOUCLE32(n) CAS_BOUCLE32((n)+32)
+#define CAS_BOUCLE128(n) CAS_BOUCLE64(n) CAS_BOUCLE64((n)+64)
+
+static bool boucle_specialisee(etat_emulateur* e, unsigned crochets){
+    switch (crochets){
+        CAS_BOUCLE128(0)
+        default: return boucle_emulateur(e, crochets);}}
+
+
+// lance l'émulateur depuis e->PC jusqu'à OUT ou sortie de la mémoire
+void lancer_emulateur(etat_emulateur* e){
+
+    // aucun crochet (ou le profil seul): interpréteur prédécodé, sans switch
+    if ((crochets_actifs(e) == 0) || (crochets_actifs(e) == CROCHET_PROFIL)){
+        cache_predecode cache;
+        predecode_init(&cache);
+        if (e->profiler) predecode_profiler(&e->m, &cache, &e->profil, 0);
+        else if (e->avance) avance_executer(&e->m, 0);
+        else predecode_executer(&e->m, &cache, 0);
+        return;}
+
+    // le stepper peut changer les options: on re-sélectionne la boucle
+    while (!boucle_specialisee(e, crochets_actifs(e)) && (e->m.raison == ARRET_AUCUN)) {}}
+
+
+// déplace la machine dans le temps selon la commande du stepper
+// renvoie false si ce n'est pas une commande de déplacement
+static bool voyage_stepper(etat_emulateur* e, const char* input){
+
+    machine* m = &e->m;
+    unsigned long n, faits = m->compteur;
+    bool atteint;
+
+    if (sscanf(input, "back %lu", &n) == 1) {
+        atteint = historique_aller(&e->retour, m, (n > faits) ? 0 : faits - n);}
+    else if ((sscanf(input, "goto cycle %lu", &n) == 1) || (sscanf(input, "goto %lu", &n) == 1)) {
+        atteint = historique_aller(&e->retour, m, n ? n - 1 : 0);} // avant le cycle n°N
+    else if (strcasecmp(input, "reverse-continue\n") == 0) {
+        atteint = historique_point_arret(&e->retour, m, e->points.execution);
+        if (!atteint) printf("Aucun passage par le point d'arrêt: retour au début.\n");}
+    else return false;
+
+    historique_defaire_passages(&e->retour, m, e->points.passages);
+    if (!atteint && (m->compteur > faits)) printf("Le programme s'arrête avant ce cycle.\n");
+    printf("\nSTEPPER: cycle n°%lu\n", m->compteur + 1);
+    return true;}
+
+
+// pose ou retire un point depuis le stepper
+// renvoie false si ce n'est pas une commande de point
+static bool commande_point(etat_emulateur* e, const char* input){
+
+    char mot[16];
+    if ((sscanf(input, "%15s", mot) != 1) || ((strcasecmp(mot, "break") != 0) && (strcasecmp(mot, "watch") != 0)
+            && (strcasecmp(mot, "rwatch") != 0) && (strcasecmp(mot, "wwatch") != 0) && (strcasecmp(mot, "delete") != 0))) return false;
+
+    const char* erreur = points_commande(&e->points, input);
+    printf("%s\n", erreur ? erreur : "Points d'arrêt mis à jour.");
+    return true;}
 
 
 // attend une action utilisateur avant chaque passage d'instruction
-void mon_stepper(int PC, int accumulateur, bool* stepper, bool* j_print, bool* ma_ram) {
+// renvoie true si la commande a déplacé la machine dans le temps
+bool mon_stepper(int PC, int accumulateur, bool* stepper, bool* j_print, bool* ma_ram, etat_emulateur* e) {
     char input[50] = {'\0'};
 
     while (input[0] == '\0') {
-        if ((*ma_ram)&&(PC==0)) printf("Initialisation de la RAM...\n\tSTEPPER: PC: 0x%02x  Accumulateur: 0x%02x\n", PC, accumulateur);
-        if ((*stepper)&&(PC>0)) printf("\nSTEPPER: PC: 0x%02x  Accumulateur: 0x%02x\n", PC, accumulateur);
+        if ((*ma_ram)&&(PC==0)) printf("Initialisation de la RAM...\n\tSTEPPER: PC: 0x" HEX_ADRESSE "  Accumulateur: 0x" HEX_MOT "\n", PC, accumulateur);
+        if ((*stepper)&&(PC>0)) printf("\nSTEPPER: PC: 0x" HEX_ADRESSE "  Accumulateur: 0x" HEX_MOT "\n", PC, accumulateur);
         printf("Appuyez sur entrée pour continuer ou entrez 'stop_stepper' pour arrêter le stepper\n");
         if ((*j_print)&&(PC>0)) printf("Entrez 'stop_print' pour arrêter les entrées détaillées\n"); // pas cette option lors initialisation RAM
         if ((!*j_print)&&(PC>0)) printf("Entrez 'print' pour affichier les entrées détaillées\n");
+        if (e) printf("Entrez 'back N', 'goto N' ou 'reverse-continue' pour remonter le temps\n");
+        if (e) printf("Entrez 'break ADR', 'watch ADR' ou 'delete ADR' pour les points d'arrêt\n");
         fgets(input, sizeof(input), stdin);
+        if ((e) && (voyage_stepper(e, input))) {return true;}
+        if ((e) && (commande_point(e, input))) {input[0] = '\0'; continue;}
         if (strcasecmp(input, "stop_stepper\n") == 0) {
             *stepper = false; } // insensible casse
         if (strcasecmp(input, "stop_print\n") == 0) {
             *j_print = false; } // maj des bools
         if (strcasecmp(input, "print\n") == 0) {
-            *j_print = true; }}}
+            *j_print = true; }}
+    return false;}
 
 
 // imprime les entrées détaillées dans le terminal
-void details_print(int compteur, int* PC, unsigned char* RAM, const char** nom_mnemonique, int accumulateur) {
+void details_print(unsigned long compteur, int* PC, const mot* RAM, const char** nom_mnemonique, int accumulateur) {
 
-    printf("Cycle d'opération n°%d: \n\tPC = 0x%02x\n\tRAM[0x%02x] = 0x%02x\n\tRAM[0x%02x] = 0x%02x\n\tAccumulateur : 0x%02x\n\t\tMnémonique:\t 0x%02x (%s)\n\t\tArgument:\t0x%02x\n\n", compteur, *PC, *PC, RAM[*PC], *PC+1, RAM[*PC+1], accumulateur, RAM[*PC], nom_mnemonique[RAM[*PC]], RAM[*PC+1]);}
+    printf("Cycle d'opération n°%lu: \n\tPC = 0x" HEX_ADRESSE "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tAccumulateur : 0x" HEX_MOT "\n\t\tMnémonique:\t 0x" HEX_MOT " (%s)\n\t\tArgument:\t0x" HEX_MOT "\n\n", compteur, *PC, *PC, RAM[*PC], *PC+1, RAM[*PC+1], accumulateur, RAM[*PC], nom_mnemonique[OPCODE(RAM[*PC])], RAM[*PC+1]);}
 
 
 // inscrit les entrées détaillées dans le journal
-void ecriture_journal(FILE* journal, int compteur, int* PC, unsigned char* RAM, const char** nom_mnemonique, int accumulateur) {
+void ecriture_journal(FILE* journal, unsigned long compteur, int* PC, const mot* RAM, const char** nom_mnemonique, int accumulateur) {
 
-    fprintf(journal, "Cycle d'opération n°%d: \n\tPC = 0x%02x\n\tRAM[0x%02x] = 0x%02x\n\tRAM[0x%02x] = 0x%02x\n\tAccumulateur : 0x%02x\n\t\tMnémonique:\t 0x%02x (%s)\n\t\tArgument:\t0x%02x\n\n", compteur, *PC, *PC, RAM[*PC], *PC+1, RAM[*PC+1], accumulateur, RAM[*PC], nom_mnemonique[RAM[*PC]], RAM[*PC+1]);}
+    fprintf(journal, "Cycle d'opération n°%lu: \n\tPC = 0x" HEX_ADRESSE "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tAccumulateur : 0x" HEX_MOT "\n\t\tMnémonique:\t 0x" HEX_MOT " (%s)\n\t\tArgument:\t0x" HEX_MOT "\n\n", compteur, *PC, *PC, RAM[*PC], *PC+1, RAM[*PC+1], accumulateur, RAM[*PC], nom_mnemonique[OPCODE(RAM[*PC])], RAM[*PC+1]);}
 
 
-//arrête l'exécution au point d'arrêt
-void breakpoint(bool* point_arret, int* adresse_point_arret, int PC) {
+//arrête l'exécution quand un point touché s'applique (conditions)
+void breakpoint(etat_emulateur* e, int PC, int accumulateur, unsigned long compteur) {
 
-    if ((*point_arret)&&(PC == *adresse_point_arret)){
-        printf("Le point d'arrêt RAM[0x%02x] est la mnémonique suivante.\n", *adresse_point_arret);
-        printf("Appuyez sur une touche pour reprendre l'exécution.\n");
-        getchar();}
+    char message[512];
+    unsigned long avant = e->points.passages[PC];
+    bool arret = points_arreter(&e->points, PC, accumulateur, &e->m.RAM[0], message, sizeof(message));
+    // le stepper peut revenir avant ce cycle: il défera ce passage
+    if ((e->stepper) && (e->points.passages[PC] != avant)) historique_passage(&e->retour, compteur, PC);
+    if (!arret) return;
+    printf("%s", message);
+    if (e->stepper) return; // le stepper attend déjà l'utilisateur
+    printf("Appuyez sur entrée pour reprendre l'exécution.\n");
+    vider_ligne();}
 
-    if ((*point_arret)&&(PC+1 == *adresse_point_arret)){
-        printf("Le point d'arrêt RAM[0x%02x] est l'argument de l'instruction suivante.\n", *adresse_point_arret);
-        printf("Appuyez sur une touche pour reprendre l'exécution.\n");
-        getchar();}}
 
+// entrée utilisateur de l'adresse breakpoint (instruction ou argument)
+void def_breakpoint(points_arret* points){
 
-// entrée utilisateur de l'adresse breakpoint
-void def_breakpoint(int* adresse_point_arret){
-
-    printf("Entrez l'adresse hexadécimale (entre 00 et 0xFF) de l'instruction à laquelle mettre le point d'arrêt : ");
-    if (scanf("%x", adresse_point_arret) != 1) {
+    int adresse_point_arret;
+    printf("Entrez l'adresse hexadécimale (entre 00 et 0x%X) de l'instruction à laquelle mettre le point d'arrêt : ", TAILLE_RAM - 1);
+    if (scanf("%x", &adresse_point_arret) != 1) {
         perror("Erreur lors de la saisie de l'adresse de point d'arrêt");
         exit(EXIT_FAILURE);}
-    else if (*adresse_point_arret < 0 || *adresse_point_arret > 0xFF) {
-        usage("Adresse invalide. L'adresse doit être comprise entre 0x0 et 0xFF.\n");}
-    else {printf("Point d'arrêt défini à l'adresse 0x%02X.\n", *adresse_point_arret);}}
+    else if (adresse_point_arret < 0 || adresse_point_arret > TAILLE_RAM - 1) {
+        char message[80];
+        snprintf(message, sizeof(message), "Adresse invalide. L'adresse doit être comprise entre 0x0 et 0x%X.\n", TAILLE_RAM - 1);
+        usage(message);}
+    else {printf("Point d'arrêt défini à l'adresse 0x%02X.\n", adresse_point_arret);}
+    vider_ligne(); // la pause du point d'arrêt lit la ligne suivante
+
+    // arrêt quand le PC est sur l'adresse ou juste avant (argument)
+    points_poser(points, adresse_point_arret, POINT_INSTRUCTION);
+    if (adresse_point_arret > 0) points_poser(points, adresse_point_arret - 1, POINT_ARGUMENT);}
+
+
+// commande de point d'arrêt passée en option (-break, -watch, ...)
+void option_point(points_arret* points, const char* commande, const char* argument){
+
+    char ligne[256];
+    snprintf(ligne, sizeof(ligne), "%s %s", commande, argument);
+    const char* erreur = points_commande(points, ligne);
+    if (erreur) {usage((char*) erreur);}}
 
 
 // affiche message d'erreur sur stderr
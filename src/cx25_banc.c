@@ -0,0 +1,479 @@
+/* *******************************************************
+ * Nom           : cx25_banc.c
+ * Rôle          : Banc d'essai et tests différentiels des moteurs
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Compilation   : make cx25_banc (ou make bench, qui le lance)
+ *
+ * Usage         : ./cx25_banc -budget N -aleatoires N -graine N
+ *                 -duree MS -differentiel
+ *
+ * Description   : Mesure les moteurs d'exécution sans trace:
+ *                      reference : machine_executer() (machine.c);
+ *                      predecode : interpréteur prédécodé (predecode.c);
+ *                      profiler : le même, avec le profil (-profile);
+ *                      avance : avance rapide des boucles (avance.c);
+ *                      voies : NB_VOIES machines en SIMD (voies.c), la
+ *                              première entrée de IN@ changée par voie.
+ *                 sur les programmes d'exemple (entrées fixées) puis sur
+ *                 des programmes aléatoires, chacun avec un budget de
+ *                 cycles (-budget, 100000 par défaut). Chaque programme
+ *                 est d'abord exécuté une fois hors mesure: le cache de
+ *                 prédécodage est chaud, gardé d'une exécution à l'autre
+ *                 comme dans cx25_lot. Chaque mesure répète les
+ *                 exécutions pendant -duree ms (200 par défaut, partagés
+ *                 entre les programmes) et affiche: instructions par
+ *                 seconde, nanosecondes et cycles du processeur (compteur
+ *                 TSC, x86 seulement) par instruction. Le RSS maximal du
+ *                 processus, commun à tous les moteurs, est affiché une
+ *                 fois à la fin.
+ *
+ *                 -differentiel: au lieu de mesurer, exécute chaque
+ *                 programme dans la référence et dans chaque moteur
+ *                 rapide côte à côte et compare l'état complet de la
+ *                 machine (RAM[], PC, accumulateur, cycles, raison,
+ *                 résultat, entrées lues), de chaque voie pour voies
+ *                 (une référence par voie) et, pour profiler, le profil
+ *                 à celui de profil_cycle() sur la référence:
+ *                      - pas à pas: après chaque instruction (budget 1,
+ *                        cache de prédécodage gardé d'un pas à l'autre);
+ *                      - par tranches de 1 à 64 cycles tirées au sort:
+ *                        les superinstructions et l'avance rapide ne
+ *                        s'appliquent que sur plusieurs cycles.
+ *                 Une boucle infinie prouvée par avance.c doit tourner
+ *                 dans la référence jusqu'au budget. Au premier écart,
+ *                 l'état des deux machines est affiché (code de sortie
+ *                 1).
+ *
+ *                 Les programmes d'exemple sont lus dans le répertoire
+ *                 courant (lancer depuis src/).
+ *
+ * ****************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sys/resource.h>
+#include "machine.h"
+#include "predecode.h"
+#include "chargeur.h"
+#include "avance.h"
+#include "voies.h"
+
+// tranches au plus du mode différentiel
+#define TRANCHE_MAX 64
+
+// entrées de IN@ données à chaque programme aléatoire
+#define NB_ENTREES 8
+
+// moteurs mesurés
+typedef enum { MOTEUR_REFERENCE, MOTEUR_PREDECODE, MOTEUR_PROFILER, MOTEUR_AVANCE, MOTEUR_VOIES, NB_MOTEURS } moteur;
+
+static const char* nom_moteur[NB_MOTEURS] = { "reference", "predecode", "profiler", "avance", "voies" };
+
+// un programme du banc: RAM[] initiale, début et entrées de IN@
+typedef struct {
+    char nom[64];
+    mot RAM[TAILLE_RAM];
+    int debut;
+    mot entrees[NB_ENTREES];
+    size_t nb_entrees;
+} programme_banc;
+
+// programmes d'exemple et leurs entrées (hex)
+static const struct { const char* chemin; int debut; const char* entrees; } exemples[] = {
+    { "prog_test.txt", 0x2E, "5" },
+    { "prog_10_5.txt", 0x30, "7 6" },
+    { "prog_10_6.txt", 0x36, "2b 6" },
+    { "prog_10_7.txt", 0x50, "5" },
+    { "prog_13_8.txt", 0x30, "5" } };
+
+// message d'erreur sur stderr
+void usage(char* message);
+
+
+// générateur xorshift64 (programmes reproductibles)
+static uint64_t aleatoire(uint64_t* etat){
+    *etat ^= *etat << 13;
+    *etat ^= *etat >> 7;
+    *etat ^= *etat << 17;
+    return *etat;}
+
+
+// programme aléatoire en 0x30: instructions connues, arguments surtout
+// dans le programme ou ses données (boucles, code auto-modifié), en
+// partie les suites que predecode.c fusionne
+static void generer(programme_banc* p, uint64_t graine){
+
+    static const unsigned char opcodes[] = { ADD_SHARP, ADD_AT, ADD_STAR_AT, SUB_SHARP, SUB_AT, SUB_STAR_AT, NAND_SHARP, NAND_AT, NAND_STAR_AT,
+        LOAD_SHARP, LOAD_AT, LOAD_STAR_AT, STORE_AT, STORE_STAR_AT, IN_AT, OUT_SHARP, OUT_AT, OUT_STAR_AT, JUMP_AT, BRN_AT, BRZ_AT };
+    static const unsigned char motifs[][4] = { {LOAD_AT, SUB_SHARP, STORE_AT, BRZ_AT}, {LOAD_AT, ADD_AT, STORE_AT}, {STORE_AT, LOAD_AT},
+        {LOAD_AT, BRZ_AT}, {SUB_SHARP, STORE_AT}, {STORE_AT, JUMP_AT} };
+    static const int longueur_motif[] = { 4, 3, 2, 2, 2, 2 };
+
+    uint64_t etat = graine * 0x9E3779B97F4A7C15ULL + 1;
+    memset(p->RAM, 0, sizeof(p->RAM));
+    int L = 8 + aleatoire(&etat) % 53, a = 0x30, j;
+
+    while (a < 0x30 + 2*L){
+        const unsigned char* ops = opcodes;
+        int n = 1;
+        if (aleatoire(&etat) % 2) {
+            int m = aleatoire(&etat) % 6;
+            ops = motifs[m];
+            n = longueur_motif[m];}
+        else ops = &opcodes[aleatoire(&etat) % sizeof(opcodes)];
+        for (j=0; (j < n) && (a < 0xFE); j++){
+            p->RAM[a++] = ops[j];
+            p->RAM[a++] = (aleatoire(&etat) % 10 < 7) ? 0x30 + aleatoire(&etat) % (2*L + 1) : aleatoire(&etat) & MASQUE_MOT;}}
+
+    snprintf(p->nom, sizeof(p->nom), "aleatoire_%lu", (unsigned long) graine);
+    p->debut = 0x30;
+    p->nb_entrees = NB_ENTREES;
+    for (j=0; j < NB_ENTREES; j++) p->entrees[j] = aleatoire(&etat);}
+
+
+// charge un programme d'exemple, false si le fichier manque
+static bool charger_exemple(programme_banc* p, int i){
+
+    const image_programme* im = charger_image(exemples[i].chemin, exemples[i].debut);
+    if (!im) return false;
+    snprintf(p->nom, sizeof(p->nom), "%s", exemples[i].chemin);
+    memcpy(p->RAM, im->RAM, sizeof(p->RAM));
+    p->debut = exemples[i].debut;
+
+    char copie[64], *reste, *mot;
+    snprintf(copie, sizeof(copie), "%s", exemples[i].entrees);
+    p->nb_entrees = 0;
+    for (mot = strtok_r(copie, " ", &reste); mot && (p->nb_entrees < NB_ENTREES); mot = strtok_r(NULL, " ", &reste))
+        p->entrees[p->nb_entrees++] = strtoul(mot, NULL, 16);
+    return true;}
+
+
+// machine prête pour le programme p
+static void preparer(machine* m, const programme_banc* p){
+    machine_init(m, p->RAM, p->debut);
+    machine_entrees(m, p->entrees, p->nb_entrees);}
+
+
+// entrées de IN@ de la voie l: celles de p, la première changée
+static void entrees_voie(const programme_banc* p, int l, mot* entrees){
+    memcpy(entrees, p->entrees, p->nb_entrees * sizeof(mot));
+    if (p->nb_entrees) entrees[0] ^= l;}
+
+
+// voies prêtes pour le programme p
+static void preparer_voies(voies* v, const programme_banc* p){
+
+    mot entrees[NB_ENTREES];
+    int l;
+    voies_init(v, p->RAM, p->debut);
+    for (l=0; l < NB_VOIES; l++){
+        entrees_voie(p, l, entrees);
+        voies_entrees(v, l, entrees, p->nb_entrees);}}
+
+
+// machine, cache et voies d'un moteur en cours de mesure
+typedef struct {
+    machine m;
+    cache_predecode cache; // décodé pour m.RAM[] en fin d'exécution
+    profil_execution profil; // cumulé sur toutes les exécutions
+    voies v;
+} banc_moteur;
+
+
+// une exécution complète de p dans le moteur, renvoie le nombre
+// d'instructions; le cache est gardé si l'exécution précédente (du même
+// programme) n'a pas écrit dans du code décodé
+static unsigned long executer(moteur mo, banc_moteur* b, const programme_banc* p, unsigned long budget){
+
+    if (mo == MOTEUR_VOIES){
+        preparer_voies(&b->v, p);
+        voies_executer(&b->v, budget);
+        unsigned long instructions = 0;
+        int l;
+        for (l=0; l < NB_VOIES; l++) instructions += b->v.compteur[l];
+        return instructions;}
+
+    if ((mo == MOTEUR_PREDECODE) || (mo == MOTEUR_PROFILER)) predecode_recharger(&b->cache, b->m.RAM, p->RAM);
+    preparer(&b->m, p);
+    switch (mo){
+        case MOTEUR_REFERENCE: machine_executer(&b->m, budget); break;
+        case MOTEUR_PREDECODE: predecode_executer(&b->m, &b->cache, budget); break;
+        case MOTEUR_PROFILER: predecode_profiler(&b->m, &b->cache, &b->profil, budget); break;
+        default: avance_executer(&b->m, budget); break;}
+    return b->m.compteur;}
+
+
+static double maintenant(void){
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;}
+
+
+// compteur de cycles du processeur, 0 s'il n'y en a pas
+static uint64_t cycles_processeur(void){
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    return 0;
+#endif
+}
+
+
+static long rss_max(void){
+    struct rusage u;
+    getrusage(RUSAGE_SELF, &u);
+    return u.ru_maxrss; // Ko sous Linux
+}
+
+
+// mesure un moteur sur nb programmes, chacun pendant au moins
+// duree / nb secondes après une exécution hors mesure (cache chaud);
+// chaque programme compte pour une exécution dans les moyennes;
+// affiche une ligne
+static void mesurer(const char* nom, const programme_banc* programmes, int nb, moteur mo, unsigned long budget, double duree){
+
+    static banc_moteur b;
+    unsigned long executions = 0;
+    double instructions = 0, secondes = 0, tsc = 0; // une exécution de chaque programme
+    int i;
+
+    for (i=0; i < nb; i++){
+        predecode_init(&b.cache);
+        profil_init(&b.profil);
+        executer(mo, &b, &programmes[i], budget);
+
+        unsigned long faites = 0, n = 0;
+        double debut = maintenant(), fin = debut;
+        uint64_t tsc_debut = cycles_processeur();
+        do {
+            unsigned long f = executer(mo, &b, &programmes[i], budget);
+            faites += f;
+            n++;
+            // l'horloge coûte plus qu'un programme court
+            if ((n % 64 == 0) || (f > 10000)) fin = maintenant();
+        } while (fin - debut < duree / nb);
+        fin = maintenant();
+        tsc += (double) (cycles_processeur() - tsc_debut) / n;
+        secondes += (fin - debut) / n;
+        instructions += (double) faites / n;
+        executions += n;}
+
+    printf("%-18s %-10s %12.0f %10lu %14.0f %9.2f ", nom, nom_moteur[mo], instructions / nb, executions,
+        instructions / secondes, instructions ? secondes * 1e9 / instructions : 0.0);
+    if (tsc && instructions) printf("%12.2f\n", tsc / instructions);
+    else printf("%12s\n", "-");}
+
+
+// compare deux machines, affiche l'écart; true si identiques
+static bool comparer(const machine* a, const machine* b, const char* nom, moteur mo, const char* mode){
+
+    if ((memcmp(a->RAM, b->RAM, sizeof(a->RAM)) == 0) && (a->PC == b->PC) && (a->accumulateur == b->accumulateur)
+            && (a->compteur == b->compteur) && (a->raison == b->raison) && (a->resultat == b->resultat)
+            && (a->pos_entree == b->pos_entree)) return true;
+
+    printf("ÉCART %s, %s (%s), après le cycle n°%lu de la référence:\n", nom, nom_moteur[mo], mode, a->compteur);
+    printf("\treference: PC 0x" HEX_ADRESSE " accumulateur 0x" HEX_MOT " cycles %lu raison %s résultat %d entrées lues %zu\n",
+        a->PC, a->accumulateur, a->compteur, nom_raison[a->raison], a->resultat, a->pos_entree);
+    printf("\t%-9s: PC 0x" HEX_ADRESSE " accumulateur 0x" HEX_MOT " cycles %lu raison %s résultat %d entrées lues %zu\n",
+        nom_moteur[mo], b->PC, b->accumulateur, b->compteur, nom_raison[b->raison], b->resultat, b->pos_entree);
+    int x;
+    for (x=0; x < TAILLE_RAM; x++)
+        if (a->RAM[x] != b->RAM[x]) printf("\tRAM[0x" HEX_ADRESSE "]: 0x" HEX_MOT " / 0x" HEX_MOT "\n", x, a->RAM[x], b->RAM[x]);
+    return false;}
+
+
+// la référence pendant pas cycles, un par un, avec profil_cycle()
+// avant chaque instruction comme la boucle de cx25.1
+static void executer_profil_reference(machine* m, profil_execution* p, unsigned long pas){
+
+    unsigned long fin = m->compteur + pas;
+    do {
+        if (PC_VALIDE(m->PC)) profil_cycle(p, m->PC, m->RAM, m->accumulateur);
+        machine_executer(m, 1);
+    } while ((m->raison == ARRET_BUDGET) && (m->compteur < fin));}
+
+
+// compare les compteurs de deux profils, affiche le premier écart; true
+// si identiques
+static bool comparer_profils(const profil_execution* a, const profil_execution* b, const char* nom, const char* mode, unsigned long compteur){
+
+    static const char* noms[] = { "exécutions", "branchements pris", "lectures", "écritures" };
+    const uint64_t* tableaux_a[] = { a->executions, a->prises, a->lectures, a->ecritures };
+    const uint64_t* tableaux_b[] = { b->executions, b->prises, b->lectures, b->ecritures };
+    int t, x;
+    for (t=0; t < 4; t++)
+        if (memcmp(tableaux_a[t], tableaux_b[t], TAILLE_RAM * sizeof(uint64_t)) != 0)
+        for (x=0; x < TAILLE_RAM; x++)
+            if (tableaux_a[t][x] != tableaux_b[t][x]){
+                printf("ÉCART %s, profiler (%s), après le cycle n°%lu: %s de 0x" HEX_ADRESSE ": %llu / %llu\n",
+                    nom, mode, compteur, noms[t], x, (unsigned long long) tableaux_a[t][x], (unsigned long long) tableaux_b[t][x]);
+                return false;}
+    if (memcmp(a->opcodes, b->opcodes, sizeof(a->opcodes)) != 0)
+    for (x=0; x < 256; x++)
+        if (a->opcodes[x] != b->opcodes[x]){
+            printf("ÉCART %s, profiler (%s), après le cycle n°%lu: opcode 0x%02X exécuté %llu / %llu fois\n",
+                nom, mode, compteur, x, (unsigned long long) a->opcodes[x], (unsigned long long) b->opcodes[x]);
+            return false;}
+    return true;}
+
+
+// état de la voie l dans une machine (pour comparer()), RAM[] comprise
+// si ram, sinon celle de reference
+static void extraire_voie(const voies* v, int l, machine* m, bool ram, const machine* reference){
+
+    int a;
+    if (ram) for (a=0; a < TAILLE_RAM; a++) m->RAM[a] = v->RAM[a][l];
+    else memcpy(m->RAM, reference->RAM, sizeof(m->RAM));
+    m->PC = v->PC[l];
+    m->accumulateur = v->accumulateur[l];
+    m->compteur = v->compteur[l];
+    m->resultat = v->resultat[l];
+    m->raison = v->raison[l];
+    m->pos_entree = v->pos_entree[l];}
+
+
+// chaque voie à côté de sa référence (ses entrées), par pas de 1 ou
+// par tranches tirées au sort; pas à pas, la RAM[] transposée des voies
+// n'est comparée que tous les TRANCHE_MAX cycles et à l'arrêt
+static bool differentiel_voies(const programme_banc* p, unsigned long budget, bool tranches, uint64_t* etat){
+
+    static voies v;
+    static machine references[NB_VOIES], voie;
+    static mot entrees[NB_VOIES][NB_ENTREES];
+    char modes[NB_VOIES][32];
+    unsigned long fait = 0;
+    int l;
+
+    preparer_voies(&v, p);
+    for (l=0; l < NB_VOIES; l++){
+        snprintf(modes[l], sizeof(modes[l]), "%s, voie %d", tranches ? "par tranches" : "pas à pas", l);
+        entrees_voie(p, l, entrees[l]);
+        machine_init(&references[l], p->RAM, p->debut);
+        machine_entrees(&references[l], entrees[l], p->nb_entrees);}
+
+    while (fait < budget){
+        unsigned long pas = tranches ? 1 + aleatoire(etat) % TRANCHE_MAX : 1;
+        if (pas > budget - fait) pas = budget - fait;
+        fait += pas;
+
+        // le budget de voies_executer() compte depuis le début: les voies
+        // arrêtées au budget précédent repartent
+        for (l=0; l < NB_VOIES; l++)
+            if (v.raison[l] == ARRET_BUDGET) {v.raison[l] = ARRET_AUCUN; v.actives[l] = -1;}
+        voies_executer(&v, fait);
+
+        bool encore = false;
+        for (l=0; l < NB_VOIES; l++){
+            machine* reference = &references[l];
+            bool tourne = (reference->raison == ARRET_AUCUN) || (reference->raison == ARRET_BUDGET);
+            if (tourne) machine_executer(reference, pas);
+            bool ram = tranches || (fait % TRANCHE_MAX == 0) || (fait == budget) || (tourne && (reference->raison != ARRET_BUDGET));
+            extraire_voie(&v, l, &voie, ram, reference);
+            if (!comparer(reference, &voie, p->nom, MOTEUR_VOIES, modes[l])) return false;
+            if (reference->raison == ARRET_BUDGET) encore = true;}
+        if (!encore) break;}
+    return true;}
+
+
+// référence et moteur côte à côte jusqu'à l'arrêt ou au budget, par pas
+// de 1 (tranches = false) ou par tranches tirées au sort
+static bool differentiel(const programme_banc* p, moteur mo, unsigned long budget, bool tranches, uint64_t* etat){
+
+    if (mo == MOTEUR_VOIES) return differentiel_voies(p, budget, tranches, etat);
+
+    static machine reference, rapide;
+    static cache_predecode cache;
+    static profil_execution profil, profil_reference;
+    const char* mode = tranches ? "par tranches" : "pas à pas";
+    preparer(&reference, p);
+    preparer(&rapide, p);
+    predecode_init(&cache); // gardé d'un pas à l'autre
+    if (mo == MOTEUR_PROFILER) {profil_init(&profil); profil_init(&profil_reference);}
+
+    while (reference.compteur < budget){
+        unsigned long pas = tranches ? 1 + aleatoire(etat) % TRANCHE_MAX : 1;
+        if (pas > budget - reference.compteur) pas = budget - reference.compteur;
+
+        if (mo == MOTEUR_PREDECODE) predecode_executer(&rapide, &cache, pas);
+        else if (mo == MOTEUR_PROFILER) predecode_profiler(&rapide, &cache, &profil, pas);
+        else avance_executer(&rapide, pas);
+
+        // boucle infinie prouvée: la référence ne doit jamais s'arrêter
+        if (rapide.raison == ARRET_BOUCLE){
+            machine_executer(&reference, budget - reference.compteur);
+            if (reference.raison == ARRET_BUDGET) return true;
+            printf("ÉCART %s, %s (%s): boucle infinie annoncée au cycle n°%lu, la référence s'arrête (%s) au cycle n°%lu.\n",
+                p->nom, nom_moteur[mo], mode, rapide.compteur, nom_raison[reference.raison], reference.compteur);
+            return false;}
+
+        if (mo == MOTEUR_PROFILER) executer_profil_reference(&reference, &profil_reference, pas);
+        else machine_executer(&reference, pas);
+        if (!comparer(&reference, &rapide, p->nom, mo, mode)) return false;
+        if (mo == MOTEUR_PROFILER) profil_solder(&profil);
+        if ((mo == MOTEUR_PROFILER) && !comparer_profils(&profil_reference, &profil, p->nom, mode, reference.compteur)) return false;
+        if (reference.raison != ARRET_BUDGET) break;}
+    return true;}
+
+
+int main(int k, char* ldc[]) {
+
+    unsigned long budget = 100000, graine = 1;
+    int nb_aleatoires = 200, i;
+    double duree = 0.2;
+    bool mode_differentiel = false;
+
+    for (i=1; i < k; i++){
+        if ((strcasecmp(ldc[i], "-budget") == 0) && (i+1 < k)) {budget = strtoul(ldc[++i], NULL, 0);}
+        else if ((strcasecmp(ldc[i], "-aleatoires") == 0) && (i+1 < k)) {nb_aleatoires = atoi(ldc[++i]);}
+        else if ((strcasecmp(ldc[i], "-graine") == 0) && (i+1 < k)) {graine = strtoul(ldc[++i], NULL, 0);}
+        else if ((strcasecmp(ldc[i], "-duree") == 0) && (i+1 < k)) {duree = atof(ldc[++i]) / 1000;}
+        else if (strcasecmp(ldc[i], "-differentiel") == 0) {mode_differentiel = true;}
+        else usage("Options: -budget N -aleatoires N -graine N -duree MS -differentiel");}
+    if ((budget == 0) || (nb_aleatoires < 0)) usage("Le budget doit être positif et le nombre de programmes aléatoires au moins 0.");
+
+    int nb_exemples = sizeof(exemples) / sizeof(exemples[0]), nb = 0;
+    programme_banc* programmes = calloc(nb_exemples + nb_aleatoires, sizeof(programme_banc));
+    if (!programmes) {perror("allocation des programmes (main)"); exit(EXIT_FAILURE);}
+    for (i=0; i < nb_exemples; i++){
+        if (charger_exemple(&programmes[nb], i)) nb++;
+        else perror(exemples[i].chemin);}
+    for (i=0; i < nb_aleatoires; i++) generer(&programmes[nb++], graine + i);
+
+    if (mode_differentiel){
+        uint64_t etat = graine * 0x2545F4914F6CDD1DULL + 1;
+        unsigned long comparaisons = 0;
+        moteur mo;
+        for (i=0; i < nb; i++)
+            for (mo = MOTEUR_PREDECODE; mo < NB_MOTEURS; mo++){
+                if (!differentiel(&programmes[i], mo, budget, false, &etat) || !differentiel(&programmes[i], mo, budget, true, &etat)) {
+                    free(programmes);
+                    return 1;}
+                comparaisons += 2;}
+        printf("Différentiel: %d programmes, %lu comparaisons complètes (budget %lu cycles), aucun écart.\n", nb, comparaisons, budget);
+        free(programmes);
+        return 0;}
+
+    printf("%-18s %-10s %12s %10s %14s %9s %12s\n", "programme", "moteur", "cycles/exéc", "exécutions", "instr/s", "ns/instr", "tsc/instr");
+    moteur mo;
+    for (i=0; i < nb - nb_aleatoires; i++)
+        for (mo = 0; mo < NB_MOTEURS; mo++) mesurer(programmes[i].nom, &programmes[i], 1, mo, budget, duree);
+    if (nb_aleatoires > 0){
+        char nom[32];
+        snprintf(nom, sizeof(nom), "aleatoires (%d)", nb_aleatoires);
+        for (mo = 0; mo < NB_MOTEURS; mo++) mesurer(nom, &programmes[nb - nb_aleatoires], nb_aleatoires, mo, budget, duree);}
+    printf("RSS maximal du processus (tous les moteurs): %ld Ko\n", rss_max());
+
+    free(programmes);
+    return 0;}
+
+
+// affiche message d'erreur sur stderr
+void usage(char* message) {fprintf(stderr, "%s\n", message) ; exit(1) ;}
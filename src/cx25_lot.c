@@ -0,0 +1,310 @@
+/* *******************************************************
+ * Nom           : cx25_lot.c
+ * Rôle          : Exécution par lots de l'ordinateur papier
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Compilation   : make (utilise machine.c)
+ *
+ * Usage         : ./cx25_lot [travaux].txt -threads N -budget N -avance
+ *
+ * Description   : Exécute des milliers de travaux indépendants dans un
+ *                 seul processus, sur tous les coeurs. Chaque ligne du
+ *                 fichier de travaux est de la forme:
+ *                      programme.txt 0x[adresse_début] [entrées hex...]
+ *                 les entrées sont données dans l'ordre aux IN@.
+ *                 Les lignes vides ou commençant par '#' sont ignorées.
+ *
+ *                 Le programme peut être un fichier texte ou une image
+ *                 binaire (chargeur.c); une image binaire impose son
+ *                 adresse de départ.
+ *
+ *                 Chaque programme n'est chargé qu'une fois. Les travaux
+ *                 sont répartis entre les threads par plages; un thread
+ *                 dont la plage est vide vole la moitié de celle d'un
+ *                 autre (vol de travail). Chaque thread possède sa propre
+ *                 machine et son cache de prédécodage, réutilisés d'un
+ *                 travail à l'autre: aucune allocation pendant l'exécution.
+ *                 Le cache n'est vidé que si le programme change ou si le
+ *                 travail précédent a écrit dans du code décodé.
+ *
+ *                 Avec -avance, les travaux tournent dans avance.c: les
+ *                 boucles de comptage sont sautées d'un coup et une
+ *                 boucle infinie prouvée s'arrête (raison "boucle").
+ *
+ *                 Sortie: une ligne par travail, dans l'ordre du fichier:
+ *                      n° résultat accumulateur cycles raison
+ *
+ * ****************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "machine.h"
+#include "predecode.h"
+#include "chargeur.h"
+#include "avance.h"
+
+// nombre de travaux pris d'un coup dans sa propre plage
+#define TRANCHE 16
+
+// un programme chargé une seule fois (par nom et adresse; le chargeur
+// partage en plus les contenus identiques)
+typedef struct {
+    char nom[256];
+    int chargement; // adresse de la ligne de travail
+    const image_programme* image;
+} programme_charge;
+
+// un travail: programme, début et entrées de IN@
+typedef struct {
+    int programme;
+    int debut;
+    size_t pos_entrees;
+    size_t nb_entrees;
+} travail;
+
+// résultat d'un travail
+typedef struct {
+    int resultat;
+    int accumulateur;
+    unsigned long compteur;
+    raison_arret raison;
+} resultat_travail;
+
+// plage de travaux [debut, fin) restant à un thread
+typedef struct {
+    pthread_mutex_t verrou;
+    size_t debut;
+    size_t fin;
+} plage;
+
+// l'ensemble du lot partagé par les threads
+typedef struct {
+    programme_charge* programmes;
+    travail* travaux;
+    resultat_travail* resultats;
+    mot* entrees;
+    plage* plages;
+    int nb_threads;
+    unsigned long budget;
+    bool avance; // avance rapide des boucles
+} lot;
+
+// un thread, sa machine et son cache de prédécodage réutilisés
+typedef struct {
+    int id;
+    lot* l;
+    machine m;
+    cache_predecode cache;
+    const image_programme* image; // programme décodé dans le cache
+} ouvrier;
+
+// prototype lecture du fichier de travaux
+size_t lire_travaux(const char* chemin, lot* l, int* nb_programmes);
+
+// prototype prise de travaux (dans sa plage ou par vol)
+bool prendre_travaux(lot* l, int id, size_t* debut, size_t* fin);
+
+// prototype thread d'exécution
+void* executer_ouvrier(void* arg);
+
+// message d'erreur sur stderr
+void usage(char* message);
+
+
+int main(int k, char* ldc[]) {
+
+    if (k<2) usage("Usage: ./cx25_lot [travaux].txt -threads N -budget N -avance\n\tChaque ligne: programme.txt 0x[adresse_début] [entrées hex...]");
+
+    lot l = { .nb_threads = (int) sysconf(_SC_NPROCESSORS_ONLN), .budget = 0, .avance = false };
+    int i;
+
+    for (i=2; i < k; i++){
+        if ((strcasecmp(ldc[i], "-threads") == 0) && (i+1 < k)) {l.nb_threads = atoi(ldc[++i]);}
+        else if ((strcasecmp(ldc[i], "-budget") == 0) && (i+1 < k)) {l.budget = strtoul(ldc[++i], NULL, 0);}
+        else if (strcasecmp(ldc[i], "-avance") == 0) {l.avance = true;}
+        else usage("Option inconnue. Options: -threads N -budget N -avance");}
+    if (l.nb_threads < 1) l.nb_threads = 1;
+
+    int nb_programmes = 0;
+    size_t nb_travaux = lire_travaux(ldc[1], &l, &nb_programmes);
+
+    l.resultats = calloc(nb_travaux ? nb_travaux : 1, sizeof(resultat_travail));
+    l.plages = calloc(l.nb_threads, sizeof(plage));
+    ouvrier* ouvriers = calloc(l.nb_threads, sizeof(ouvrier));
+    pthread_t* threads = calloc(l.nb_threads, sizeof(pthread_t));
+    if (!l.resultats || !l.plages || !ouvriers || !threads) {
+        perror("allocation du lot (main)");
+        exit(EXIT_FAILURE);}
+
+    // découpage initial en plages égales
+    for (i=0; i < l.nb_threads; i++){
+        pthread_mutex_init(&l.plages[i].verrou, NULL);
+        l.plages[i].debut = nb_travaux * i / l.nb_threads;
+        l.plages[i].fin = nb_travaux * (i+1) / l.nb_threads;}
+
+    for (i=0; i < l.nb_threads; i++){
+        ouvriers[i].id = i;
+        ouvriers[i].l = &l;
+        if (pthread_create(&threads[i], NULL, executer_ouvrier, &ouvriers[i]) != 0) {
+            perror("création des threads (main)");
+            exit(EXIT_FAILURE);}}
+
+    for (i=0; i < l.nb_threads; i++) pthread_join(threads[i], NULL);
+
+    size_t j;
+    for (j=0; j < nb_travaux; j++){
+        resultat_travail* r = &l.resultats[j];
+        if (r->resultat >= 0) printf("%zu 0x" HEX_MOT " 0x" HEX_MOT " %lu %s\n", j, r->resultat, r->accumulateur, r->compteur, nom_raison[r->raison]);
+        else printf("%zu - 0x" HEX_MOT " %lu %s\n", j, r->accumulateur, r->compteur, nom_raison[r->raison]);}
+
+    for (i=0; i < l.nb_threads; i++) pthread_mutex_destroy(&l.plages[i].verrou);
+    free(threads); free(ouvriers); free(l.plages); free(l.resultats);
+    free(l.travaux); free(l.entrees); free(l.programmes);
+    return 0; }
+
+
+// lit le fichier de travaux et charge chaque programme une seule fois
+size_t lire_travaux(const char* chemin, lot* l, int* nb_programmes){
+
+    FILE* fichier = fopen(chemin, "r");
+    if (! fichier){
+        perror("fichier de travaux (lire_travaux)");
+        exit(EXIT_FAILURE);}
+
+    size_t nb = 0, capacite = 0, nb_entrees = 0, capacite_entrees = 0;
+    int capacite_programmes = 0;
+    char ligne[4096];
+
+    while (fgets(ligne, sizeof(ligne), fichier)) {
+        char* jeton = strtok(ligne, " \t\r\n");
+        if ((!jeton) || (jeton[0] == '#')) continue;
+        char* debut = strtok(NULL, " \t\r\n");
+        if (!debut) usage("Travail sans adresse de début.");
+
+        // programme déjà chargé à cette adresse ?
+        int p, chargement = strtol(debut, NULL, 16);
+        for (p=0; p < *nb_programmes; p++)
+            if ((l->programmes[p].chargement == chargement) && (strcmp(l->programmes[p].nom, jeton) == 0)) break;
+        if (p == *nb_programmes){
+            if (p == capacite_programmes){
+                capacite_programmes = capacite_programmes ? 2*capacite_programmes : 8;
+                l->programmes = realloc(l->programmes, capacite_programmes * sizeof(programme_charge));
+                if (!l->programmes) {perror("allocation des programmes"); exit(EXIT_FAILURE);}}
+            programme_charge* pc = &l->programmes[p];
+            snprintf(pc->nom, sizeof(pc->nom), "%s", jeton);
+            pc->chargement = chargement;
+            pc->image = charger_image(jeton, chargement);
+            if (!pc->image){
+                perror(jeton);
+                exit(EXIT_FAILURE);}
+            // une image binaire impose son adresse de départ
+            if (pc->image->binaire && (pc->image->depart != chargement)) {
+                fprintf(stderr, "%s: %s\n", jeton, valider_depart(pc->image, chargement));
+                exit(EXIT_FAILURE);}
+            (*nb_programmes)++;}
+
+        if (nb == capacite){
+            capacite = capacite ? 2*capacite : 1024;
+            l->travaux = realloc(l->travaux, capacite * sizeof(travail));
+            if (!l->travaux) {perror("allocation des travaux"); exit(EXIT_FAILURE);}}
+
+        travail* t = &l->travaux[nb++];
+        t->programme = p;
+        t->debut = chargement;
+        t->pos_entrees = nb_entrees;
+        t->nb_entrees = 0;
+
+        // entrées hexadécimales de IN@
+        while ((jeton = strtok(NULL, " \t\r\n"))) {
+            if (nb_entrees == capacite_entrees){
+                capacite_entrees = capacite_entrees ? 2*capacite_entrees : 4096;
+                l->entrees = realloc(l->entrees, capacite_entrees * sizeof(*l->entrees));
+                if (!l->entrees) {perror("allocation des entrées"); exit(EXIT_FAILURE);}}
+            char* fin;
+            unsigned long v = strtoul(jeton, &fin, 16);
+            if ((fin == jeton) || (*fin != '\0') || (v > MASQUE_MOT)) usage("Entrée de IN@ invalide dans le fichier de travaux.");
+            l->entrees[nb_entrees++] = v;
+            t->nb_entrees++;}}
+
+    if (fclose(fichier) != 0) {
+        perror("Erreur lors de la fermeture du fichier de travaux");
+        exit(EXIT_FAILURE);}
+    return nb;}
+
+
+// prend une tranche dans sa plage, sinon vole la moitié d'une autre plage
+bool prendre_travaux(lot* l, int id, size_t* debut, size_t* fin){
+
+    plage* mienne = &l->plages[id];
+
+    pthread_mutex_lock(&mienne->verrou);
+    if (mienne->debut < mienne->fin){
+        *debut = mienne->debut;
+        *fin = (mienne->fin - mienne->debut > TRANCHE) ? *debut + TRANCHE : mienne->fin;
+        mienne->debut = *fin;
+        pthread_mutex_unlock(&mienne->verrou);
+        return true;}
+    pthread_mutex_unlock(&mienne->verrou);
+
+    // vol de travail: on parcourt les autres threads
+    int i;
+    for (i=1; i < l->nb_threads; i++){
+        plage* victime = &l->plages[(id + i) % l->nb_threads];
+        pthread_mutex_lock(&victime->verrou);
+        size_t reste = victime->fin - victime->debut;
+        if (reste > 0){
+            size_t milieu = victime->fin - (reste + 1) / 2; // on prend la moitié de la fin
+            size_t vol_debut = milieu, vol_fin = victime->fin;
+            victime->fin = milieu;
+            pthread_mutex_unlock(&victime->verrou);
+
+            // une tranche tout de suite, le reste dans sa propre plage
+            *debut = vol_debut;
+            *fin = (vol_fin - vol_debut > TRANCHE) ? vol_debut + TRANCHE : vol_fin;
+            pthread_mutex_lock(&mienne->verrou);
+            mienne->debut = *fin;
+            mienne->fin = vol_fin;
+            pthread_mutex_unlock(&mienne->verrou);
+            return true;}
+        pthread_mutex_unlock(&victime->verrou);}
+    return false;}
+
+
+// exécute des travaux tant qu'il en reste
+void* executer_ouvrier(void* arg){
+
+    ouvrier* o = arg;
+    lot* l = o->l;
+    size_t debut, fin, j;
+
+    while (prendre_travaux(l, o->id, &debut, &fin)){
+        for (j=debut; j < fin; j++){
+            travail* t = &l->travaux[j];
+            const image_programme* im = l->programmes[t->programme].image;
+            if (!l->avance){
+                if (im != o->image) predecode_init(&o->cache);
+                else predecode_recharger(&o->cache, o->m.RAM, im->RAM);
+                o->image = im;}
+            machine_init(&o->m, im->RAM, t->debut);
+            machine_entrees(&o->m, &l->entrees[t->pos_entrees], t->nb_entrees);
+            if (l->avance) avance_executer(&o->m, l->budget);
+            else predecode_executer(&o->m, &o->cache, l->budget);
+
+            resultat_travail* r = &l->resultats[j];
+            r->resultat = o->m.resultat;
+            r->accumulateur = o->m.accumulateur;
+            r->compteur = o->m.compteur;
+            r->raison = o->m.raison;}}
+    return NULL;}
+
+
+// affiche message d'erreur sur stderr
+void usage(char* message) {fprintf(stderr, "%s\n", message) ; exit(1) ;}
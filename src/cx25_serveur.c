@@ -0,0 +1,550 @@
+/* *******************************************************
+ * Nom           : cx25_serveur.c
+ * Rôle          : Serveur d'exécution de l'ordinateur papier
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Compilation   : make (utilise machine.c)
+ *
+ * Usage         : ./cx25_serveur [socket] -threads N -budget N -avance
+ *
+ * Description   : Processus qui reste ouvert sur une socket Unix locale
+ *                 et exécute les requêtes de ses clients, sans relancer
+ *                 cx25.1 pour chaque programme. Une requête par ligne,
+ *                 une réponse par ligne:
+ *                      image NOM 0x[chargement] [bytes hex...]
+ *                          -> ok NOM
+ *                      fichier NOM chemin 0x[chargement]
+ *                          -> ok NOM
+ *                      executer NOM 0x[début] budget [entrées hex...]
+ *                          -> résultat accumulateur cycles raison
+ *                 image garde un programme sous un nom, fichier le lit
+ *                 côté serveur (texte ou image binaire, chargeur.c).
+ *                 Les deux passent par le cache du chargeur: renvoyer
+ *                 les mêmes bytes redonne la même image, sans mémoire
+ *                 en plus.
+ *                 Les noms sont communs à toutes les connexions. Un
+ *                 budget 0 prend celui de -budget (BUDGET_DEFAUT cycles
+ *                 par défaut, 0 = illimité sur demande expresse). Les
+ *                 entrées sont données dans l'ordre aux IN@. Une requête
+ *                 refusée répond "erreur message". Les lignes vides ou
+ *                 commençant par '#' sont ignorées (pas de réponse).
+ *
+ *                 Les requêtes peuvent être envoyées à la suite sans
+ *                 attendre les réponses: chaque connexion a un thread de
+ *                 lecture qui découpe ce qui arrive en lots, exécutés
+ *                 par les ouvriers (-threads, un par coeur par défaut).
+ *                 Les réponses sont rangées dans l'ordre des requêtes et
+ *                 un thread d'écriture par connexion les envoie: un
+ *                 client qui envoie tout avant de lire ne bloque pas le
+ *                 serveur (ses réponses attendent en mémoire). Au plus
+ *                 FENETRE lots non exécutés par connexion: au-delà, la
+ *                 lecture attend.
+ *
+ *                 Chaque ouvrier garde sa machine et son cache de
+ *                 prédécodage, comme cx25_lot (mêmes réponses): le cache
+ *                 n'est vidé que si le programme change ou si la requête
+ *                 précédente a écrit dans du code décodé. Avec
+ *                 -avance, les requêtes tournent dans avance.c.
+ *
+ * ****************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "machine.h"
+#include "predecode.h"
+#include "chargeur.h"
+#include "avance.h"
+
+// budget par défaut d'une requête: un client ne peut pas bloquer un
+// ouvrier sans le demander (-budget 0)
+#define BUDGET_DEFAUT 10000000
+
+// requêtes au plus dans un lot
+#define LOT_MAX 64
+
+// lots en attente au plus par connexion
+#define FENETRE 32
+
+// longueur maximale d'une ligne de requête
+#define LIGNE_MAX 4096
+
+// bytes lus d'un coup sur la socket
+#define LECTURE 65536
+
+// entrées de IN@ au plus dans un lot (une ligne en a au plus LIGNE_MAX / 2)
+#define ENTREES_MAX (2 * LIGNE_MAX)
+
+// longueur maximale d'une réponse
+#define REPONSE_MAX 256
+
+// alvéoles de la table des noms
+#define NOMS 1024
+
+// séparateurs des mots d'une requête
+#define SEPARATEURS " \t\r"
+
+// un programme gardé sous un nom
+typedef struct image_nommee {
+    char nom[64];
+    const image_programme* image;
+    struct image_nommee* suivante;
+} image_nommee;
+
+// une requête executer (image NULL: réponse déjà écrite)
+typedef struct {
+    const image_programme* image;
+    int debut;
+    unsigned long budget;
+    size_t pos_entrees;
+    size_t nb_entrees;
+    char reponse[REPONSE_MAX];
+} requete;
+
+struct connexion;
+
+// requêtes consécutives d'une connexion, exécutées par un seul ouvrier
+typedef struct lot_requetes {
+    struct connexion* c;
+    struct lot_requetes* suivant; // file des ouvriers
+    struct lot_requetes* apres; // ordre des réponses de la connexion
+    bool pret;
+    int nb;
+    requete requetes[LOT_MAX];
+    mot entrees[ENTREES_MAX];
+    size_t nb_entrees;
+} lot_requetes;
+
+// état partagé par tous les threads
+typedef struct {
+    pthread_mutex_t verrou; // file des lots
+    pthread_cond_t travail;
+    lot_requetes *tete, *queue;
+    pthread_rwlock_t verrou_noms;
+    image_nommee* noms[NOMS];
+    pthread_mutex_t verrou_chargeur; // le chargeur n'a pas de verrou
+    unsigned long budget;
+    bool avance;
+} serveur;
+
+// un client
+typedef struct connexion {
+    serveur* s;
+    int fd;
+    pthread_mutex_t verrou;
+    pthread_cond_t place; // un lot de moins en attente
+    pthread_cond_t a_ecrire; // réponses rangées ou lecture finie
+    lot_requetes *tete, *queue; // lots pas encore répondus, dans l'ordre
+    int en_attente; // lots pas encore exécutés
+    char* sortie; // réponses prêtes, dans l'ordre
+    size_t taille_sortie, capacite_sortie;
+    bool lecture_finie;
+} connexion;
+
+// un ouvrier, sa machine et son cache de prédécodage réutilisés
+typedef struct {
+    serveur* s;
+    machine m;
+    cache_predecode cache;
+    const image_programme* image; // programme décodé dans le cache
+} ouvrier;
+
+// prototype thread de lecture d'une connexion
+void* lire_connexion(void* arg);
+
+// prototype thread d'écriture d'une connexion
+void* ecrire_connexion(void* arg);
+
+// prototype thread d'exécution des lots
+void* executer_ouvrier(void* arg);
+
+// message d'erreur sur stderr
+void usage(char* message);
+
+
+int main(int k, char* ldc[]) {
+
+    if (k<2) usage("Usage: ./cx25_serveur [socket] -threads N -budget N -avance\n\tRequêtes: image NOM 0x[chargement] bytes... | fichier NOM chemin 0x[chargement] | executer NOM 0x[début] budget [entrées hex...]");
+
+    serveur s = { .budget = BUDGET_DEFAUT, .avance = false };
+    int nb_threads = (int) sysconf(_SC_NPROCESSORS_ONLN), i;
+
+    for (i=2; i < k; i++){
+        if ((strcasecmp(ldc[i], "-threads") == 0) && (i+1 < k)) {nb_threads = atoi(ldc[++i]);}
+        else if ((strcasecmp(ldc[i], "-budget") == 0) && (i+1 < k)) {s.budget = strtoul(ldc[++i], NULL, 0);}
+        else if (strcasecmp(ldc[i], "-avance") == 0) {s.avance = true;}
+        else usage("Option inconnue. Options: -threads N -budget N -avance");}
+    if (nb_threads < 1) nb_threads = 1;
+
+    struct sockaddr_un adresse = { .sun_family = AF_UNIX };
+    if (strlen(ldc[1]) >= sizeof(adresse.sun_path)) usage("Chemin de socket trop long.");
+    strcpy(adresse.sun_path, ldc[1]);
+
+    int ecoute = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (ecoute < 0) {perror("socket (main)"); exit(EXIT_FAILURE);}
+    unlink(ldc[1]); // socket laissée par un serveur précédent
+    if ((bind(ecoute, (struct sockaddr*) &adresse, sizeof(adresse)) != 0) || (listen(ecoute, 128) != 0)) {
+        perror(ldc[1]);
+        exit(EXIT_FAILURE);}
+
+    // un client qui part ne doit pas arrêter le serveur
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_mutex_init(&s.verrou, NULL);
+    pthread_cond_init(&s.travail, NULL);
+    pthread_rwlock_init(&s.verrou_noms, NULL);
+    pthread_mutex_init(&s.verrou_chargeur, NULL);
+
+    for (i=0; i < nb_threads; i++){
+        ouvrier* o = calloc(1, sizeof(ouvrier));
+        pthread_t thread;
+        if (!o) {perror("allocation des ouvriers (main)"); exit(EXIT_FAILURE);}
+        o->s = &s;
+        if (pthread_create(&thread, NULL, executer_ouvrier, o) != 0) {
+            perror("création des threads (main)");
+            exit(EXIT_FAILURE);}
+        pthread_detach(thread);}
+
+    fprintf(stderr, "cx25_serveur: %s, %d ouvriers\n", ldc[1], nb_threads);
+
+    while (true){
+        int fd = accept(ecoute, NULL, NULL);
+        if (fd < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED)) continue;
+            perror("accept (main)");
+            exit(EXIT_FAILURE);}
+
+        connexion* c = calloc(1, sizeof(connexion));
+        pthread_t lecteur, ecrivain;
+        if (!c) {perror("allocation d'une connexion (main)"); exit(EXIT_FAILURE);}
+        c->s = &s;
+        c->fd = fd;
+        pthread_mutex_init(&c->verrou, NULL);
+        pthread_cond_init(&c->place, NULL);
+        pthread_cond_init(&c->a_ecrire, NULL);
+        if ((pthread_create(&lecteur, NULL, lire_connexion, c) != 0) || (pthread_create(&ecrivain, NULL, ecrire_connexion, c) != 0)) {
+            perror("création des threads (main)");
+            exit(EXIT_FAILURE);}
+        pthread_detach(lecteur);
+        pthread_detach(ecrivain);}}
+
+
+// empreinte FNV-1a d'un nom
+static unsigned alveole(const char* nom){
+
+    uint32_t h = 2166136261u;
+    while (*nom) h = (h ^ (unsigned char) *nom++) * 16777619u;
+    return h % NOMS;}
+
+
+// programme gardé sous ce nom, NULL si aucun
+static const image_programme* chercher_nom(serveur* s, const char* nom){
+
+    const image_programme* im = NULL;
+    pthread_rwlock_rdlock(&s->verrou_noms);
+    image_nommee* n;
+    for (n = s->noms[alveole(nom)]; n; n = n->suivante)
+        if (strcmp(n->nom, nom) == 0) {im = n->image; break;}
+    pthread_rwlock_unlock(&s->verrou_noms);
+    return im;}
+
+
+// garde im sous ce nom (remplace l'ancien: les requêtes déjà lues
+// gardent l'ancien programme, jamais libéré)
+static void nommer(serveur* s, const char* nom, const image_programme* im){
+
+    pthread_rwlock_wrlock(&s->verrou_noms);
+    unsigned a = alveole(nom);
+    image_nommee* n;
+    for (n = s->noms[a]; n; n = n->suivante)
+        if (strcmp(n->nom, nom) == 0) break;
+    if (!n){
+        n = calloc(1, sizeof(image_nommee));
+        if (!n) {perror("allocation d'un nom (nommer)"); exit(EXIT_FAILURE);}
+        snprintf(n->nom, sizeof(n->nom), "%s", nom);
+        n->suivante = s->noms[a];
+        s->noms[a] = n;}
+    n->image = im;
+    pthread_rwlock_unlock(&s->verrou_noms);}
+
+
+// lit une valeur hexadécimale entre 0 et max, -1 si invalide
+static int lire_hexa(const char* mot, long max){
+
+    char* fin;
+    long v = strtol(mot, &fin, 16);
+    if ((fin == mot) || (*fin != '\0') || (v < 0) || (v > max)) return -1;
+    return v;}
+
+
+// analyse une ligne dans la requête r du lot (le lot a la place pour
+// ses entrées)
+static void analyser_requete(serveur* s, char* ligne, lot_requetes* l, requete* r){
+
+    char *reste, *mot;
+    r->image = NULL;
+    r->reponse[0] = '\0';
+
+    char* commande = strtok_r(ligne, SEPARATEURS, &reste);
+    char* nom = strtok_r(NULL, SEPARATEURS, &reste);
+    if ((!nom) || (strlen(nom) >= sizeof(((image_nommee*) 0)->nom))) {snprintf(r->reponse, REPONSE_MAX, "erreur Nom manquant ou trop long (63 caractères au plus).\n"); return;}
+
+    if (strcmp(commande, "executer") == 0){
+        char* debut = strtok_r(NULL, SEPARATEURS, &reste);
+        char* budget = strtok_r(NULL, SEPARATEURS, &reste);
+        if (!budget) {snprintf(r->reponse, REPONSE_MAX, "erreur Requête: executer NOM 0x[début] budget [entrées hex...]\n"); return;}
+        const image_programme* im = chercher_nom(s, nom);
+        if (!im) {snprintf(r->reponse, REPONSE_MAX, "erreur Programme inconnu: %s\n", nom); return;}
+        r->debut = lire_hexa(debut, TAILLE_RAM - 1);
+        const char* erreur = (r->debut < 0) ? "Adresse de début invalide." : valider_depart(im, r->debut);
+        if (erreur) {snprintf(r->reponse, REPONSE_MAX, "erreur %s\n", erreur); return;}
+        r->budget = strtoul(budget, NULL, 0);
+        if (r->budget == 0) r->budget = s->budget;
+
+        // entrées de IN@, à la suite de celles du lot
+        size_t n = l->nb_entrees;
+        while ((mot = strtok_r(NULL, SEPARATEURS, &reste))){
+            int v = lire_hexa(mot, MASQUE_MOT);
+            if (v < 0) {snprintf(r->reponse, REPONSE_MAX, "erreur Entrée invalide: %.64s\n", mot); return;}
+            l->entrees[n++] = v;}
+        r->pos_entrees = l->nb_entrees;
+        r->nb_entrees = n - l->nb_entrees;
+        l->nb_entrees = n;
+        r->image = im;
+        return;}
+
+    if (strcmp(commande, "image") == 0){
+        char* chargement = strtok_r(NULL, SEPARATEURS, &reste);
+        int a = chargement ? lire_hexa(chargement, TAILLE_RAM - 1) : -1;
+        if (a < 0) {snprintf(r->reponse, REPONSE_MAX, "erreur Requête: image NOM 0x[chargement] [bytes hex...]\n"); return;}
+        // par le cache du chargeur: les mêmes bytes rendent la même image
+        // (pas de fuite, le cache prédécodé des ouvriers reste valable)
+        pthread_mutex_lock(&s->verrou_chargeur);
+        const image_programme* im = charger_texte(reste, strlen(reste), a);
+        pthread_mutex_unlock(&s->verrou_chargeur);
+        nommer(s, nom, im);
+        snprintf(r->reponse, REPONSE_MAX, "ok %s\n", nom);
+        return;}
+
+    if (strcmp(commande, "fichier") == 0){
+        char* chemin = strtok_r(NULL, SEPARATEURS, &reste);
+        char* chargement = strtok_r(NULL, SEPARATEURS, &reste);
+        int a = chargement ? lire_hexa(chargement, TAILLE_RAM - 1) : -1;
+        if ((!chemin) || (a < 0)) {snprintf(r->reponse, REPONSE_MAX, "erreur Requête: fichier NOM chemin 0x[chargement]\n"); return;}
+        pthread_mutex_lock(&s->verrou_chargeur);
+        const image_programme* im = charger_image(chemin, a);
+        int erreur = errno;
+        pthread_mutex_unlock(&s->verrou_chargeur);
+        if (!im) {snprintf(r->reponse, REPONSE_MAX, "erreur %.128s: %s\n", chemin, strerror(erreur)); return;}
+        nommer(s, nom, im);
+        snprintf(r->reponse, REPONSE_MAX, "ok %s\n", nom);
+        return;}
+
+    snprintf(r->reponse, REPONSE_MAX, "erreur Requête inconnue (image, fichier ou executer).\n");}
+
+
+// passe le lot aux ouvriers, dans l'ordre de la connexion
+static void envoyer_lot(connexion* c, lot_requetes* l){
+
+    pthread_mutex_lock(&c->verrou);
+    while (c->en_attente >= FENETRE) pthread_cond_wait(&c->place, &c->verrou);
+    if (c->queue) c->queue->apres = l;
+    else c->tete = l;
+    c->queue = l;
+    c->en_attente++;
+    pthread_mutex_unlock(&c->verrou);
+
+    serveur* s = c->s;
+    pthread_mutex_lock(&s->verrou);
+    if (s->queue) s->queue->suivant = l;
+    else s->tete = l;
+    s->queue = l;
+    pthread_cond_signal(&s->travail);
+    pthread_mutex_unlock(&s->verrou);}
+
+
+static lot_requetes* nouveau_lot(connexion* c){
+
+    lot_requetes* l = malloc(sizeof(lot_requetes));
+    if (!l) {perror("allocation d'un lot (nouveau_lot)"); exit(EXIT_FAILURE);}
+    l->c = c;
+    l->suivant = l->apres = NULL;
+    l->pret = false;
+    l->nb = 0;
+    l->nb_entrees = 0;
+    return l;}
+
+
+// découpe ce que le client envoie en lots de requêtes
+void* lire_connexion(void* arg){
+
+    connexion* c = arg;
+    char tampon[LECTURE + LIGNE_MAX];
+    size_t garde = 0; // début de ligne incomplète au début du tampon
+    bool trop_longue = false; // ligne en cours jetée jusqu'au '\n'
+    lot_requetes* l = NULL;
+    ssize_t lus;
+
+    while ((lus = read(c->fd, tampon + garde, LECTURE)) != 0){
+        if (lus < 0) {
+            if (errno == EINTR) continue;
+            break;}
+
+        char *ligne = tampon, *fin = tampon + garde + lus, *nl;
+        while ((nl = memchr(ligne, '\n', fin - ligne))){
+            *nl = '\0';
+            if (nl - ligne >= LIGNE_MAX) trop_longue = true;
+            char* premier = ligne + strspn(ligne, SEPARATEURS);
+            if ((!trop_longue) && ((*premier == '\0') || (*premier == '#'))) {ligne = nl + 1; continue;}
+
+            // entrées du lot pleines: la ligne passe dans un nouveau lot
+            if (l && (l->nb_entrees + (nl - ligne) / 2 + 1 > ENTREES_MAX)) {envoyer_lot(c, l); l = NULL;}
+            if (!l) l = nouveau_lot(c);
+            requete* r = &l->requetes[l->nb];
+            if (trop_longue) {
+                snprintf(r->reponse, REPONSE_MAX, "erreur Ligne trop longue (%d caractères au plus).\n", LIGNE_MAX - 1);
+                r->image = NULL;
+                trop_longue = false;}
+            else analyser_requete(c->s, ligne, l, r);
+            if (++l->nb == LOT_MAX) {envoyer_lot(c, l); l = NULL;}
+            ligne = nl + 1;}
+
+        // ce qui est lu est envoyé: un client qui attend sa réponse l'a
+        if (l) {envoyer_lot(c, l); l = NULL;}
+
+        garde = fin - ligne;
+        if (garde >= LIGNE_MAX) {trop_longue = true; garde = 0;}
+        else memmove(tampon, ligne, garde);}
+
+    pthread_mutex_lock(&c->verrou);
+    c->lecture_finie = true;
+    pthread_cond_signal(&c->a_ecrire);
+    pthread_mutex_unlock(&c->verrou);
+    return NULL;}
+
+
+// écrit tout, faux si le client ne lit plus
+static bool ecrire_tout(int fd, const char* texte, size_t n){
+
+    while (n > 0){
+        ssize_t ecrits = write(fd, texte, n);
+        if (ecrits < 0) {
+            if (errno == EINTR) continue;
+            return false;}
+        texte += ecrits;
+        n -= ecrits;}
+    return true;}
+
+
+// envoie les réponses rangées; ferme et libère la connexion quand la
+// lecture est finie et tout est répondu
+void* ecrire_connexion(void* arg){
+
+    connexion* c = arg;
+    char* envoi = NULL; // échangé avec c->sortie
+    size_t capacite_envoi = 0;
+    bool fermee = false; // le client ne lit plus: réponses jetées
+
+    pthread_mutex_lock(&c->verrou);
+    while (true){
+        while ((c->taille_sortie == 0) && !(c->lecture_finie && (c->en_attente == 0) && (!c->tete)))
+            pthread_cond_wait(&c->a_ecrire, &c->verrou);
+        if (c->taille_sortie == 0) break;
+
+        char* pleine = c->sortie;
+        size_t n = c->taille_sortie, capacite = c->capacite_sortie;
+        c->sortie = envoi;
+        c->capacite_sortie = capacite_envoi;
+        c->taille_sortie = 0;
+        envoi = pleine;
+        capacite_envoi = capacite;
+        pthread_mutex_unlock(&c->verrou);
+
+        if ((!fermee) && (!ecrire_tout(c->fd, envoi, n))) fermee = true;
+        pthread_mutex_lock(&c->verrou);}
+    pthread_mutex_unlock(&c->verrou);
+
+    close(c->fd);
+    pthread_mutex_destroy(&c->verrou);
+    pthread_cond_destroy(&c->place);
+    pthread_cond_destroy(&c->a_ecrire);
+    free(c->sortie);
+    free(envoi);
+    free(c);
+    return NULL;}
+
+
+// ajoute les réponses du lot à la sortie de la connexion (verrou pris)
+static void ranger_reponses(connexion* c, const lot_requetes* l){
+
+    int j;
+    for (j=0; j < l->nb; j++){
+        size_t t = strlen(l->requetes[j].reponse);
+        if (c->taille_sortie + t > c->capacite_sortie){
+            c->capacite_sortie = c->capacite_sortie ? 2 * c->capacite_sortie : LOT_MAX * REPONSE_MAX;
+            c->sortie = realloc(c->sortie, c->capacite_sortie);
+            if (!c->sortie) {perror("allocation des réponses (ranger_reponses)"); exit(EXIT_FAILURE);}}
+        memcpy(c->sortie + c->taille_sortie, l->requetes[j].reponse, t);
+        c->taille_sortie += t;}}
+
+
+// exécute les lots de la file et range les réponses prêtes
+void* executer_ouvrier(void* arg){
+
+    ouvrier* o = arg;
+    serveur* s = o->s;
+
+    while (true){
+        pthread_mutex_lock(&s->verrou);
+        while (!s->tete) pthread_cond_wait(&s->travail, &s->verrou);
+        lot_requetes* l = s->tete;
+        s->tete = l->suivant;
+        if (!s->tete) s->queue = NULL;
+        pthread_mutex_unlock(&s->verrou);
+
+        int j;
+        for (j=0; j < l->nb; j++){
+            requete* r = &l->requetes[j];
+            if (!r->image) continue;
+            // les images ne sont jamais libérées: leur adresse les identifie
+            if (!s->avance){
+                if (r->image != o->image) predecode_init(&o->cache);
+                else predecode_recharger(&o->cache, o->m.RAM, r->image->RAM);
+                o->image = r->image;}
+            machine_init(&o->m, r->image->RAM, r->debut);
+            machine_entrees(&o->m, &l->entrees[r->pos_entrees], r->nb_entrees);
+            if (s->avance) avance_executer(&o->m, r->budget);
+            else predecode_executer(&o->m, &o->cache, r->budget);
+            if (o->m.resultat >= 0) snprintf(r->reponse, REPONSE_MAX, "0x" HEX_MOT " 0x" HEX_MOT " %lu %s\n", o->m.resultat, o->m.accumulateur, o->m.compteur, nom_raison[o->m.raison]);
+            else snprintf(r->reponse, REPONSE_MAX, "- 0x" HEX_MOT " %lu %s\n", o->m.accumulateur, o->m.compteur, nom_raison[o->m.raison]);}
+
+        // les lots prêts en tête de la connexion sont rangés dans l'ordre
+        connexion* c = l->c;
+        pthread_mutex_lock(&c->verrou);
+        l->pret = true;
+        c->en_attente--;
+        while (c->tete && c->tete->pret){
+            lot_requetes* premier = c->tete;
+            ranger_reponses(c, premier);
+            c->tete = premier->apres;
+            if (!c->tete) c->queue = NULL;
+            free(premier);}
+        pthread_cond_signal(&c->place);
+        pthread_cond_signal(&c->a_ecrire);
+        pthread_mutex_unlock(&c->verrou);}
+    return NULL;}
+
+
+// affiche message d'erreur sur stderr
+void usage(char* message) {fprintf(stderr, "%s\n", message) ; exit(1) ;}
@@ -0,0 +1,206 @@
+/* *******************************************************
+ * Nom           : cx25_trace.c
+ * Rôle          : Décodeur de la trace binaire de cx25.1
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Compilation   : make (utilise machine.c)
+ *
+ * Usage         : ./cx25_trace [trace].bin -adresses MIN MAX
+ *                 -opcodes MIN MAX -ecritures -sequences N
+ *
+ * Description   : Relit une trace écrite par "./cx25.1 ... -trace" et
+ *                 imprime sur stdout le journal texte, identique à celui
+ *                 de l'option -journal. Options (valeurs hexadécimales):
+ *                      -adresses MIN MAX : seulement les cycles dont le
+ *                                          PC ou l'adresse écrite est
+ *                                          entre MIN et MAX;
+ *                      -opcodes MIN MAX : seulement les cycles dont
+ *                                         l'opcode est entre MIN et MAX;
+ *                      -ecritures : ajoute à chaque cycle l'écriture
+ *                                   faite en RAM[] (hors format journal);
+ *                      -sequences N : au lieu du journal, les N paires et
+ *                                     triplets d'opcodes exécutés à la
+ *                                     suite (PC, PC+2, PC+4) les plus
+ *                                     fréquents (N en décimal), pour
+ *                                     choisir les superinstructions.
+ *
+ * ****************************************************** */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "machine.h"
+#include "trace.h"
+
+// intervalles retenus (bornes incluses)
+typedef struct {
+    int adresse_min, adresse_max;
+    int opcode_min, opcode_max;
+    bool ecritures;
+} filtre_trace;
+
+// opcodes connus numérotés de 0 à NB_CONNUS-1, les autres en NB_CONNUS
+#define NB_CONNUS 22
+static const unsigned char connus[NB_CONNUS] = { ADD_SHARP, ADD_AT, ADD_STAR_AT, SUB_SHARP, SUB_AT, SUB_STAR_AT, NAND_SHARP, NAND_AT, NAND_STAR_AT,
+    LOAD_SHARP, LOAD_AT, LOAD_STAR_AT, STORE_AT, STORE_STAR_AT, IN_AT, IN_STAR_AT, OUT_SHARP, OUT_AT, OUT_STAR_AT, JUMP_AT, BRN_AT, BRZ_AT };
+#define NB_CLASSES (NB_CONNUS + 1)
+
+// séquences exécutées à la suite, par numéro d'opcode
+typedef struct {
+    unsigned char classe[256];
+    uint64_t paires[NB_CLASSES][NB_CLASSES];
+    uint64_t triplets[NB_CLASSES][NB_CLASSES][NB_CLASSES];
+    int precedents[2]; // deux derniers numéros de la suite, -1 = aucun
+    int PC; // PC du dernier cycle compté
+} sequences_trace;
+
+// une ligne du classement
+typedef struct {
+    uint64_t nombre;
+    int classes[3];
+    int longueur;
+} sequence;
+
+// message d'erreur sur stderr
+void usage(char* message);
+
+
+// le cycle passe-t-il le filtre ?
+static bool retenu(const filtre_trace* f, const enregistrement_trace* r){
+
+    bool adresse = ((r->PC >= f->adresse_min) && (r->PC <= f->adresse_max))
+        || ((r->drapeaux & TRACE_ECRITURE) && (r->adresse_ecrite >= f->adresse_min) && (r->adresse_ecrite <= f->adresse_max));
+    return adresse && (r->opcode >= f->opcode_min) && (r->opcode <= f->opcode_max);}
+
+
+// même texte que ecriture_journal() de cx25.1.c
+static void imprimer_cycle(FILE* sortie, unsigned long compteur, const enregistrement_trace* r, bool ecritures){
+
+    fprintf(sortie, "Cycle d'opération n°%lu: \n\tPC = 0x" HEX_ADRESSE "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tRAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\tAccumulateur : 0x" HEX_MOT "\n\t\tMnémonique:\t 0x" HEX_MOT " (%s)\n\t\tArgument:\t0x" HEX_MOT "\n\n", compteur, r->PC, r->PC, r->opcode, r->PC+1, r->argument, r->accumulateur, r->opcode, nom_mnemonique[OPCODE(r->opcode)], r->argument);
+    if (ecritures && (r->drapeaux & TRACE_ECRITURE))
+        fprintf(sortie, "\tÉcriture: RAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT "\n\n", r->adresse_ecrite, r->valeur_ecrite);}
+
+
+// aucune séquence comptée
+static void sequences_init(sequences_trace* s){
+
+    int i;
+    memset(s, 0, sizeof(*s));
+    memset(s->classe, NB_CONNUS, sizeof(s->classe));
+    for (i=0; i < NB_CONNUS; i++) s->classe[connus[i]] = i;
+    s->precedents[0] = s->precedents[1] = -1;
+    s->PC = -1;}
+
+
+// compte le cycle: la suite continue si le PC a avancé de 2
+static void sequences_cycle(sequences_trace* s, const enregistrement_trace* r){
+
+    int c = s->classe[OPCODE(r->opcode)];
+    if (r->PC != s->PC + 2) s->precedents[0] = s->precedents[1] = -1;
+    if (s->precedents[1] >= 0) s->paires[s->precedents[1]][c]++;
+    if (s->precedents[0] >= 0) s->triplets[s->precedents[0]][s->precedents[1]][c]++;
+    s->precedents[0] = s->precedents[1];
+    s->precedents[1] = c;
+    s->PC = r->PC;}
+
+
+// les plus fréquentes d'abord
+static int par_nombre(const void* a, const void* b){
+    const sequence *x = a, *y = b;
+    return (x->nombre < y->nombre) - (x->nombre > y->nombre);}
+
+
+// nom d'un numéro d'opcode
+static const char* nom_classe(int c){
+    return (c < NB_CONNUS) ? nom_mnemonique[connus[c]] : "inconnue";}
+
+
+// imprime les n séquences de chaque longueur les plus fréquentes
+static void imprimer_sequences(const sequences_trace* s, int n){
+
+    static sequence liste[NB_CLASSES * NB_CLASSES * NB_CLASSES];
+    int longueur, i, j, l, nb;
+
+    for (longueur = 2; longueur <= 3; longueur++){
+        nb = 0;
+        for (i=0; i < NB_CLASSES; i++)
+            for (j=0; j < NB_CLASSES; j++)
+                for (l=0; l < ((longueur == 3) ? NB_CLASSES : 1); l++){
+                    uint64_t nombre = (longueur == 3) ? s->triplets[i][j][l] : s->paires[i][j];
+                    if (nombre) liste[nb++] = (sequence) { nombre, { i, j, l }, longueur };}
+        qsort(liste, nb, sizeof(sequence), par_nombre);
+
+        printf("%s:\n", (longueur == 2) ? "Paires" : "Triplets");
+        for (i=0; (i < nb) && (i < n); i++){
+            printf("%12lu", (unsigned long) liste[i].nombre);
+            for (j=0; j < longueur; j++) printf(" %s", nom_classe(liste[i].classes[j]));
+            printf("\n");}}}
+
+
+int main(int k, char* ldc[]) {
+
+    if (k<2) usage("Usage: ./cx25_trace [trace].bin -adresses MIN MAX -opcodes MIN MAX -ecritures -sequences N");
+
+    filtre_trace f = { .adresse_min = 0, .adresse_max = TAILLE_RAM - 1, .opcode_min = 0, .opcode_max = MASQUE_MOT, .ecritures = false };
+    int i, nb_sequences = 0;
+
+    for (i=2; i < k; i++){
+        if ((strcasecmp(ldc[i], "-adresses") == 0) && (i+2 < k)) {
+            f.adresse_min = strtol(ldc[i+1], NULL, 16); f.adresse_max = strtol(ldc[i+2], NULL, 16); i += 2;}
+        else if ((strcasecmp(ldc[i], "-opcodes") == 0) && (i+2 < k)) {
+            f.opcode_min = strtol(ldc[i+1], NULL, 16); f.opcode_max = strtol(ldc[i+2], NULL, 16); i += 2;}
+        else if (strcasecmp(ldc[i], "-ecritures") == 0) {f.ecritures = true;}
+        else if ((strcasecmp(ldc[i], "-sequences") == 0) && (i+1 < k) && (atoi(ldc[i+1]) > 0)) {nb_sequences = atoi(ldc[++i]);}
+        else usage("Option inconnue. Options: -adresses MIN MAX -opcodes MIN MAX -ecritures -sequences N");}
+
+    FILE* fichier = fopen(ldc[1], "rb");
+    if (!fichier) {
+        perror("fichier trace (main)");
+        exit(EXIT_FAILURE);}
+
+    entete_trace entete;
+    if ((fread(&entete, sizeof(entete), 1, fichier) != 1) || (memcmp(entete.magie, "CX25TRC", 8) != 0))
+        usage("Ce fichier n'est pas une trace de cx25.1.");
+    if ((entete.version != TRACE_VERSION) || (entete.taille != sizeof(enregistrement_trace)))
+        usage("Version de trace non reconnue.");
+
+    enregistrement_trace* bloc = malloc(TRACE_BLOC * sizeof(enregistrement_trace));
+    sequences_trace* s = nb_sequences ? malloc(sizeof(sequences_trace)) : NULL;
+    if ((!bloc) || (nb_sequences && !s)) {
+        perror("allocation du bloc (main)");
+        exit(EXIT_FAILURE);}
+    if (s) sequences_init(s);
+
+    // le numéro de cycle ne garde que 32 bits: une forte baisse signale le
+    // passage des 32 bits suivants (une petite: retour du stepper)
+    unsigned long haut = 0;
+    uint32_t precedent = 0;
+    size_t n;
+
+    while ((n = fread(bloc, sizeof(enregistrement_trace), TRACE_BLOC, fichier)) > 0){
+        size_t j;
+        for (j=0; j < n; j++){
+            if ((bloc[j].compteur < precedent) && (precedent - bloc[j].compteur > 0x80000000u)) haut += 1UL << 32;
+            precedent = bloc[j].compteur;
+            if (!retenu(&f, &bloc[j])) continue;
+            if (s) sequences_cycle(s, &bloc[j]);
+            else imprimer_cycle(stdout, haut | bloc[j].compteur, &bloc[j], f.ecritures);}}
+
+    if (ferror(fichier)) {
+        perror("Erreur lors de la lecture du fichier trace");
+        exit(EXIT_FAILURE);}
+
+    if (s) imprimer_sequences(s, nb_sequences);
+    free(s);
+    free(bloc);
+    fclose(fichier);
+    return 0;}
+
+
+// message d'erreur
+void usage(char* message) {fprintf(stderr, "%s\n", message) ; exit(1) ;}
@@ -0,0 +1,81 @@
+/* *******************************************************
+ * Nom           : machine.c
+ * Rôle          : Machine réentrante de l'ordinateur papier
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Initialisation, chargement et exécution d'une
+ *                 struct machine. Aucune variable globale modifiable:
+ *                 plusieurs machines peuvent tourner en parallèle.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include "machine.h"
+
+// tableau pour affichage des mnémoniques dans les cycles
+const char* nom_mnemonique[256] = { [ADD_SHARP] = "ADD#", [ADD_AT] = "ADD@", [ADD_STAR_AT] = "ADD*@", [SUB_SHARP] = "SUB#", [SUB_AT] = "SUB@", [SUB_STAR_AT] = "SUB*@", [NAND_SHARP] = "NAND#", [NAND_AT] = "NAND@", [NAND_STAR_AT] = "NAND*@", [LOAD_SHARP] = "LOAD#", [LOAD_AT] = "LOAD@", [LOAD_STAR_AT] = "LOAD*@", [STORE_AT] = "STORE@", [STORE_STAR_AT] = "STORE*@", [IN_AT] = "IN@", [IN_STAR_AT] = "IN*@", [OUT_SHARP] = "OUT#", [OUT_AT] = "OUT@", [OUT_STAR_AT] = "OUT*@", [JUMP_AT] = "JUMP@", [BRN_AT] = "BRN@", [BRZ_AT] = "BRZ@" };
+
+// accès aux données de chaque opcode (IN*@ ne stocke rien)
+const unsigned char acces_opcode[256] = {
+    [ADD_AT] = ACCES_LIT, [SUB_AT] = ACCES_LIT, [NAND_AT] = ACCES_LIT, [LOAD_AT] = ACCES_LIT, [OUT_AT] = ACCES_LIT,
+    [ADD_STAR_AT] = ACCES_LIT_IND, [SUB_STAR_AT] = ACCES_LIT_IND, [NAND_STAR_AT] = ACCES_LIT_IND,
+    [LOAD_STAR_AT] = ACCES_LIT_IND, [OUT_STAR_AT] = ACCES_LIT_IND,
+    [STORE_AT] = ACCES_ECRIT, [IN_AT] = ACCES_ECRIT,
+    [STORE_STAR_AT] = ACCES_LIT | ACCES_ECRIT_IND };
+
+// nom des raisons d'arrêt
+const char* nom_raison[] = { [ARRET_AUCUN] = "aucun", [ARRET_OUT] = "out", [ARRET_PC] = "pc", [ARRET_BUDGET] = "budget", [ARRET_ENTREE] = "entree", [ARRET_BOUCLE] = "boucle" };
+
+
+// copie une image mémoire et place le PC au début
+void machine_init(machine* m, const mot* image, int debut){
+
+    memcpy(m->RAM, image, sizeof(m->RAM));
+    m->PC = debut;
+    m->accumulateur = 0x0;
+    m->compteur = 0;
+    m->resultat = -1;
+    m->raison = ARRET_AUCUN;
+    m->entrees_tampon = false;
+    m->entrees = NULL;
+    m->nb_entrees = 0;
+    m->pos_entree = 0;}
+
+
+// les IN@ liront ce tampon au lieu de stdin
+void machine_entrees(machine* m, const mot* entrees, size_t nb){
+
+    m->entrees_tampon = true;
+    m->entrees = entrees;
+    m->nb_entrees = nb;
+    m->pos_entree = 0;}
+
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire ou budget
+raison_arret machine_executer(machine* m, unsigned long budget){
+
+    int PC = m->PC, accumulateur = m->accumulateur;
+    unsigned long compteur = m->compteur;
+    unsigned long limite = budget ? compteur + budget : (unsigned long) -1;
+
+    m->raison = ARRET_AUCUN;
+    while (PC_VALIDE(PC)){
+        if (compteur >= limite) {m->raison = ARRET_BUDGET; break;}
+        compteur ++;
+        if (executer_instruction(m, &PC, &accumulateur, false)) break;}
+
+    if (m->raison == ARRET_AUCUN) m->raison = ARRET_PC;
+    m->PC = PC; m->accumulateur = accumulateur; m->compteur = compteur;
+    return m->raison;}
+
+
+// un cycle de référence, avec la trace verbeuse des instructions
+void emulation(machine* m){
+
+    if (executer_instruction(m, &m->PC, &m->accumulateur, true)) return;
+    m->raison = ARRET_AUCUN;}
+
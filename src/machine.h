@@ -0,0 +1,291 @@
+/* *******************************************************
+ * Nom           : machine.h
+ * Rôle          : État réentrant de l'ordinateur papier + cycle
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Toute la machine (RAM[], PC, accumulateur, compteur)
+ *                 tient dans une struct machine: on peut en avoir autant
+ *                 que l'on veut dans un même processus (lot, threads).
+ *                 Les entrées de IN@ viennent soit de stdin, soit d'un
+ *                 tampon fourni avec machine_entrees().
+ *                 La taille de RAM[] et la largeur des adresses et de
+ *                 l'accumulateur sont fixées à la compilation (voir
+ *                 CX25_BITS_ADRESSE plus bas).
+ *
+ * ****************************************************** */
+
+#ifndef MACHINE_H
+#define MACHINE_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// codes opératoires
+enum { ADD_SHARP = 0x20, ADD_AT = 0x60, ADD_STAR_AT = 0xE0, SUB_SHARP = 0x21, SUB_AT = 0x61, SUB_STAR_AT = 0xE1, NAND_SHARP = 0x22, NAND_AT = 0x62, NAND_STAR_AT = 0xE2, LOAD_SHARP = 0x0, LOAD_AT = 0x40, LOAD_STAR_AT = 0xC0, STORE_AT = 0x48, STORE_STAR_AT = 0xC8, IN_AT = 0x49, IN_STAR_AT = 0xC9, OUT_SHARP = 0x01, OUT_AT = 0x41, OUT_STAR_AT = 0xC1, JUMP_AT = 0x10, BRN_AT = 0x11, BRZ_AT = 0x12 };
+
+// configuration de la machine, choisie à la compilation (make MACHINE="-D..."):
+//      CX25_BITS_ADRESSE : adresses sur 8 (défaut) ou 16 bits;
+//      CX25_BITS_ACCUMULATEUR : mots de RAM[] (valeur rangée par STORE@,
+//                               signe de BRN@) sur 8 ou 16 bits, au moins
+//                               la largeur des adresses (un mot contient
+//                               un argument ou un pointeur);
+//      CX25_TAILLE_RAM : nombre de mots, puissance de 2, de 64 à
+//                        2^CX25_BITS_ADRESSE (défaut).
+// Une adresse lue dans un mot est prise modulo TAILLE_RAM. Par défaut:
+// la machine de 256 bytes, sans aucun masque.
+#ifndef CX25_BITS_ADRESSE
+#define CX25_BITS_ADRESSE 8
+#endif
+#ifndef CX25_BITS_ACCUMULATEUR
+#define CX25_BITS_ACCUMULATEUR CX25_BITS_ADRESSE
+#endif
+#ifndef CX25_TAILLE_RAM
+#define CX25_TAILLE_RAM (1 << CX25_BITS_ADRESSE)
+#endif
+
+#if (CX25_BITS_ADRESSE != 8) && (CX25_BITS_ADRESSE != 16)
+#error "CX25_BITS_ADRESSE vaut 8 ou 16"
+#endif
+#if ((CX25_BITS_ACCUMULATEUR != 8) && (CX25_BITS_ACCUMULATEUR != 16)) || (CX25_BITS_ACCUMULATEUR < CX25_BITS_ADRESSE)
+#error "CX25_BITS_ACCUMULATEUR vaut 8 ou 16, au moins CX25_BITS_ADRESSE"
+#endif
+#if (CX25_TAILLE_RAM < 64) || (CX25_TAILLE_RAM > (1 << CX25_BITS_ADRESSE)) || (CX25_TAILLE_RAM & (CX25_TAILLE_RAM - 1))
+#error "CX25_TAILLE_RAM est une puissance de 2 entre 64 et 2^CX25_BITS_ADRESSE"
+#endif
+
+// taille de la mémoire et fenêtre où le PC est valide
+#define TAILLE_RAM CX25_TAILLE_RAM
+#define PC_VALIDE(pc) (((pc) > 0x1F) && ((pc) < TAILLE_RAM - 1)) // entre 16 et 254 (base 10) par défaut
+
+// un mot de RAM[] (opcode, argument ou donnée), formats de printf / scanf
+#if CX25_BITS_ACCUMULATEUR == 8
+typedef unsigned char mot;
+#define HEX_MOT "%02x"
+#define SCAN_MOT "%hhx"
+#else
+typedef unsigned short mot;
+#define HEX_MOT "%04x"
+#define SCAN_MOT "%hx"
+#endif
+#define MASQUE_MOT ((1 << CX25_BITS_ACCUMULATEUR) - 1)
+#define BIT_SIGNE (1 << (CX25_BITS_ACCUMULATEUR - 1)) // testé par BRN@
+
+// format d'une adresse
+#if CX25_BITS_ADRESSE == 8
+#define HEX_ADRESSE "%02x"
+#else
+#define HEX_ADRESSE "%04x"
+#endif
+
+// mot lu comme adresse: sans masque quand chaque mot désigne une case
+#if TAILLE_RAM == (1 << CX25_BITS_ACCUMULATEUR)
+#define ADRESSE(x) (x)
+#else
+#define ADRESSE(x) ((x) & (TAILLE_RAM - 1))
+#endif
+
+// mot lu comme opcode (les tables ont 256 entrées, 0xFF n'est pas connu)
+#if CX25_BITS_ACCUMULATEUR == 8
+#define OPCODE(x) (x)
+#else
+#define OPCODE(x) (((x) > 0xFF) ? 0xFF : (x))
+#endif
+
+// RAM[x] et RAM[RAM[x]] pour un argument x (@ et *@)
+#define CASE(RAM, x) ((RAM)[ADRESSE(x)])
+#define POINTEE(RAM, x) CASE(RAM, CASE(RAM, x))
+
+// raison de l'arrêt de la machine
+typedef enum { ARRET_AUCUN, ARRET_OUT, ARRET_PC, ARRET_BUDGET, ARRET_ENTREE, ARRET_BOUCLE } raison_arret;
+
+// une machine complète: aucune variable globale
+typedef struct machine {
+    mot RAM[TAILLE_RAM]; // mémoire 256 bytes par défaut
+    int PC;
+    int accumulateur;
+    unsigned long compteur; // nombre de cycles exécutés
+    int resultat; // valeur affichée par OUT (-1 si aucune)
+    raison_arret raison;
+    // entrées de IN@: tampon si entrees_tampon, sinon stdin
+    bool entrees_tampon;
+    const mot* entrees;
+    size_t nb_entrees;
+    size_t pos_entree;
+} machine;
+
+// tableau pour affichage des mnémoniques dans les cycles
+extern const char* nom_mnemonique[256];
+
+// accès aux données de chaque opcode (drapeaux), arg = RAM[PC+1]
+// (tables indexées par OPCODE())
+enum { ACCES_LIT = 1, ACCES_LIT_IND = 2, ACCES_ECRIT = 4, ACCES_ECRIT_IND = 8 };
+
+// RAM[arg] lu ou écrit (@), RAM[RAM[arg]] lu ou écrit (*@)
+extern const unsigned char acces_opcode[256];
+
+// nom des raisons d'arrêt
+extern const char* nom_raison[];
+
+// n'affiche la trace des instructions que si demandé
+#define TRACE(...) do { if (trace) printf(__VA_ARGS__); } while (0)
+
+// copie une image mémoire et place le PC au début
+void machine_init(machine* m, const mot* image, int debut);
+
+// les IN@ liront ce tampon au lieu de stdin
+void machine_entrees(machine* m, const mot* entrees, size_t nb);
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire ou budget
+// budget = nombre maximal de cycles, 0 = illimité
+raison_arret machine_executer(machine* m, unsigned long budget);
+
+// un cycle de référence, avec la trace verbeuse des instructions
+void emulation(machine* m);
+
+
+// vide la fin de ligne de stdin (s'arrête aussi en fin de fichier)
+static inline void vider_ligne(void){
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);}
+
+
+// lit la prochaine entrée de IN@ (tampon ou utilisateur)
+static inline bool lire_entree(machine* m, mot* valeur){
+    if (m->entrees_tampon){
+        if (m->pos_entree >= m->nb_entrees) return false;
+        *valeur = m->entrees[m->pos_entree++];
+        return true;}
+    if (scanf(SCAN_MOT, valeur) != 1) {
+        perror("Erreur lors de la saisie de la valeur hexadécimale");
+        exit(EXIT_FAILURE); }
+    return true;}
+
+
+// un cycle de l'ordinateur en papier, trace = impression des instructions
+// toujours "inline": trace est une constante et les printf disparaissent
+// renvoie vrai quand la machine s'arrête (OUT ou entrée manquante)
+static inline __attribute__((always_inline)) bool executer_instruction(machine* m, int* PC, int* accumulateur, const bool trace){
+
+            mot* RAM = m->RAM;
+
+            switch (RAM[*PC]){
+
+            case ADD_SHARP://ADD# ajoute l'entier immédiat à acc
+            *accumulateur += RAM[*PC+1];
+            TRACE("\tADD# 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case ADD_AT://ADD@ ajoute la valeur de l'adresse spécifiée à acc
+            *accumulateur += CASE(RAM, RAM[*PC+1]);
+            TRACE("\tADD@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case ADD_STAR_AT: //ADD*@ ajoute la valeur d'un ptr de ptr à acc
+            *accumulateur += POINTEE(RAM, RAM[*PC+1]);
+            TRACE("\tADD*@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case SUB_SHARP://SUB# soustrait entier immédiat
+            *accumulateur -= RAM[*PC+1];
+            TRACE("\tSUB# 0x" HEX_MOT "\n\tPC = [0x" HEX_ADRESSE "]\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *PC, *accumulateur); *PC +=2; break;
+
+            case SUB_AT://SUB@ soustrait la valeur de l'adresse spécifiée
+            *accumulateur -= CASE(RAM, RAM[*PC+1]);
+            TRACE("\tSUB@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case SUB_STAR_AT://SUB*@ soustrait la valeur via ptr de ptr
+            *accumulateur -= POINTEE(RAM, RAM[*PC+1]);
+            TRACE("\tSUB*@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case NAND_SHARP://NAND# bit à bit avec entier immédiat
+            *accumulateur = ~(*accumulateur & RAM[*PC+1]);
+            TRACE("\tNAND# 0x" HEX_MOT "\n\n\n", RAM[*PC+1]);*PC +=2;break;
+
+            case NAND_AT://NAND@ bit à bit avec valeur de l'ad. spécifiée
+            *accumulateur = ~(*accumulateur & CASE(RAM, RAM[*PC+1]));
+            TRACE("\tNAND@ 0x" HEX_MOT "\n\n\n", RAM[*PC+1]);*PC +=2;break;
+
+            case NAND_STAR_AT://NAND*@ bit à bit via ptr de ptr
+            *accumulateur = ~(*accumulateur & POINTEE(RAM, RAM[*PC+1]));
+            TRACE("\tNAND*@ 0x" HEX_MOT "\n\n\n", RAM[*PC+1]);*PC +=2;break;
+
+            case LOAD_SHARP://LOAD# charge entier immédiat
+            *accumulateur = RAM[*PC+1];
+            TRACE("\tLOAD# 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case LOAD_AT://LOAD@ charge entier d'ad. mémoire
+            *accumulateur = CASE(RAM, RAM[*PC+1]);
+            TRACE("\tLOAD@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2;break;
+
+            case LOAD_STAR_AT://LOAD*@ charge entier via ptr de ptr
+            *accumulateur = POINTEE(RAM, RAM[*PC+1]);
+            TRACE("\tLOAD*@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\n\n", RAM[*PC+1], *accumulateur); *PC +=2; break;
+
+            case STORE_AT://STORE@ stocke acc. dans ad. mémoire
+            CASE(RAM, RAM[*PC+1]) = *accumulateur;
+            TRACE("\tSTORE@ 0x" HEX_MOT "\n\n\n", RAM[*PC+1]);*PC +=2;break;
+
+            case STORE_STAR_AT://STORE*@ stocke acc. dans ptr de ptr
+            TRACE("\n"); POINTEE(RAM, RAM[*PC+1]) = *accumulateur;
+            TRACE("\tSTORE*@ 0x" HEX_MOT "\n\n\n", RAM[*PC+1]); *PC +=2; break;
+
+            case IN_AT://IN@ lit entrée user et la stocke dans ad. mémoire
+            TRACE("\tIN@ 0x" HEX_MOT,RAM[*PC+1]);
+            TRACE("\n\tEntrez une valeur hexadécimale:");
+            if (!lire_entree(m, &CASE(RAM, RAM[*PC+1]))) {
+                m->raison = ARRET_ENTREE; return true;}
+            TRACE("\n");
+            if (!m->entrees_tampon) vider_ligne(); // vide buffer pour stepper
+            TRACE("\tValeur entrée: 0x" HEX_MOT "\n\n\n", CASE(RAM, RAM[*PC+1]));*PC +=2; break;
+
+            case IN_STAR_AT://IN*@ lit entrée user et la stocke dans ptr de ptr
+            TRACE("\tIN*@ 0x" HEX_MOT "\n\tEntrez une valeur hexadécimale:",RAM[*PC+1]);
+            //if (scanf("%hhx", &RAM[RAM[RAM[*PC+1]]]) != 1) {
+                //perror("Erreur lors de la saisie de la valeur hexadécimale");
+                //exit(EXIT_FAILURE);}
+            if (!m->entrees_tampon) vider_ligne(); // vide buffer pour stepper
+            else if (m->pos_entree < m->nb_entrees) m->pos_entree++; // la ligne est consommée
+            TRACE("\tValeur entrée: 0x" HEX_MOT "\n\n\n", POINTEE(RAM, RAM[*PC+1]));*PC +=2; break;
+
+            case OUT_SHARP: //OUT# affiche résultat immédiat en sortie
+            TRACE("\tOUT# 0x" HEX_MOT "\n\tLe résultat est: 0x" HEX_MOT "\n\n\n",RAM[*PC+1], RAM[*PC+1]);
+            m->resultat = RAM[*PC+1];
+            m->raison = ARRET_OUT; return true;
+
+            case OUT_AT://OUT@ affiche résultat à une ad. mémoire sur la sortie
+            TRACE("\tOUT@ 0x" HEX_MOT "\n\tLe résultat est: 0x" HEX_MOT "\n\n\n",RAM[*PC+1], CASE(RAM, RAM[*PC+1]));
+            m->resultat = CASE(RAM, RAM[*PC+1]);
+            m->raison = ARRET_OUT; return true;
+
+            case OUT_STAR_AT://OUT*@ affiche un résultat pointé par un ptr de ptr
+            TRACE("\tOUT*@ 0x" HEX_MOT "\n\tLe résultat est: 0x" HEX_MOT "\n\n\n",RAM[*PC+1], POINTEE(RAM, RAM[*PC+1]));
+            m->resultat = POINTEE(RAM, RAM[*PC+1]);
+            m->raison = ARRET_OUT; *PC +=2; return true;
+
+            case JUMP_AT://JUMP@ saut inconditionnel vers ad. mémoire
+            TRACE("\tJUMP@ 0x" HEX_MOT "\n\n\n", RAM[*PC+1]);
+            *PC = ADRESSE(RAM[*PC+1]); break;
+
+            case BRN_AT://BRN@ saut conditionnel si acc <0
+            TRACE("\tBRN@ 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\tSi l'accumulateur < 0, PC <- [0x" HEX_MOT "]\n\n\n",RAM[*PC+1], *accumulateur, RAM[*PC+1]);
+            if (*accumulateur & BIT_SIGNE) // vérifie si le bit est de signe 1
+                *PC = ADRESSE(RAM[*PC+1]);
+            else *PC+=2;
+            break;
+
+            case BRZ_AT://BRZ@ saut conditionnel si acc = 0
+            TRACE("\tBRZ_AT 0x" HEX_MOT "\n\tAccumulateur = 0x" HEX_MOT "\n\tSi l'accumulateur = 0, PC <- [0x" HEX_MOT "]\n\n\n",RAM[*PC+1], *accumulateur, RAM[*PC+1]);
+            if (*accumulateur == 0)
+                *PC = ADRESSE(RAM[*PC+1]);
+            else *PC+=2;
+            break;
+
+            default:
+            TRACE("Instruction non reconnue : %d\n", RAM[*PC]);
+            break;}
+
+            return false;}
+
+#endif
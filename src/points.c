@@ -0,0 +1,181 @@
+/* *******************************************************
+ * Nom           : points.c
+ * Rôle          : Points d'arrêt et points de surveillance du débogueur
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Pose et retrait des points, lecture des commandes et
+ *                 examen des conditions quand un bit est touché.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include <stdarg.h>
+#include "points.h"
+
+// séparateurs des mots d'une commande
+#define SEPARATEURS " \t,\r\n"
+
+
+void points_init(points_arret* p){
+
+    memset(p, 0, sizeof(*p));
+    int a;
+    for (a=0; a < TAILLE_RAM; a++) {p->condition[a] = -1; p->seuil[a] = 1;}}
+
+
+static void mettre_bit(uint64_t* bits, int adresse, bool valeur){
+    if (valeur) bits[adresse >> 6] |= 1ULL << (adresse & 63);
+    else bits[adresse >> 6] &= ~(1ULL << (adresse & 63));}
+
+
+// met les bits de l'adresse d'accord avec son genre
+static void recalculer(points_arret* p, int adresse){
+
+    unsigned char g = p->genre[adresse];
+    mettre_bit(p->execution, adresse, g & (POINT_INSTRUCTION | POINT_ARGUMENT));
+    mettre_bit(p->lecture, adresse, g & POINT_LECTURE);
+    mettre_bit(p->ecriture, adresse, g & POINT_ECRITURE);
+
+    int a;
+    p->nb = 0;
+    for (a=0; a < TAILLE_RAM; a++) if (p->genre[a]) p->nb++;}
+
+
+// ajoute des points (genre) à une adresse
+void points_poser(points_arret* p, int adresse, int genre){
+    p->genre[adresse] |= genre;
+    recalculer(p, adresse);}
+
+
+// lit une valeur hexadécimale entre 0 et max, -1 si invalide
+static int lire_hexa(const char* mot, long max){
+
+    char* fin;
+    long v = strtol(mot, &fin, 16);
+    if ((fin == mot) || (*fin != '\0') || (v < 0) || (v > max)) return -1;
+    return v;}
+
+
+// exécute une commande, NULL si elle est acceptée
+const char* points_commande(points_arret* p, const char* ligne){
+
+    char copie[256], *reste;
+    snprintf(copie, sizeof(copie), "%s", ligne);
+
+    char* commande = strtok_r(copie, SEPARATEURS, &reste);
+    if ((!commande) || (commande[0] == '#')) return NULL; // ligne vide ou commentaire
+    char* mot = strtok_r(NULL, SEPARATEURS, &reste);
+    if (!mot) return "Adresse manquante après la commande.";
+    static char erreur[96];
+    int adresse = lire_hexa(mot, TAILLE_RAM - 1);
+    if (adresse < 0) {
+        snprintf(erreur, sizeof(erreur), "Adresse invalide. L'adresse doit être comprise entre 0x0 et 0x%X.", TAILLE_RAM - 1);
+        return erreur;}
+
+    if (strcasecmp(commande, "break") == 0) {
+        int condition = -1;
+        unsigned long seuil = 1;
+        while ((mot = strtok_r(NULL, SEPARATEURS, &reste))){
+            if (strncasecmp(mot, "acc=", 4) == 0) {
+                if ((condition = lire_hexa(mot + 4, MASQUE_MOT)) < 0) {
+                    snprintf(erreur, sizeof(erreur), "Condition acc=V: V doit être une valeur hexadécimale sur %d bits.", CX25_BITS_ACCUMULATEUR);
+                    return erreur;}}
+            else if (strncasecmp(mot, "passage=", 8) == 0) {
+                char* fin;
+                seuil = strtoul(mot + 8, &fin, 10);
+                if ((fin == mot + 8) || (*fin != '\0') || (seuil == 0)) return "Condition passage=N: N doit être un entier positif.";}
+            else return "Condition inconnue (acc=V ou passage=N).";}
+        p->condition[adresse] = condition;
+        p->seuil[adresse] = seuil;
+        p->passages[adresse] = 0;
+        points_poser(p, adresse, POINT_INSTRUCTION);}
+    else if (strcasecmp(commande, "watch") == 0) {points_poser(p, adresse, POINT_LECTURE | POINT_ECRITURE);}
+    else if (strcasecmp(commande, "rwatch") == 0) {points_poser(p, adresse, POINT_LECTURE);}
+    else if (strcasecmp(commande, "wwatch") == 0) {points_poser(p, adresse, POINT_ECRITURE);}
+    else if (strcasecmp(commande, "delete") == 0) {
+        // tous les points de l'adresse, y compris celui sur l'argument
+        p->genre[adresse] = 0;
+        p->condition[adresse] = -1; p->seuil[adresse] = 1; p->passages[adresse] = 0;
+        recalculer(p, adresse);
+        if ((adresse > 0) && (p->genre[adresse-1] & POINT_ARGUMENT)) {
+            p->genre[adresse-1] &= ~POINT_ARGUMENT;
+            recalculer(p, adresse-1);}}
+    else return "Commande inconnue (break, watch, rwatch, wwatch ou delete).";
+
+    return NULL;}
+
+
+// exécute les commandes d'un fichier
+bool points_fichier(points_arret* p, const char* chemin){
+
+    FILE* fichier = fopen(chemin, "r");
+    if (!fichier) {
+        perror("fichier de points d'arrêt (points_fichier)");
+        return false;}
+
+    char ligne[256];
+    int numero = 0;
+    bool ok = true;
+    while (ok && fgets(ligne, sizeof(ligne), fichier)){
+        numero++;
+        const char* erreur = points_commande(p, ligne);
+        if (erreur) {
+            fprintf(stderr, "%s, ligne %d: %s\n", chemin, numero, erreur);
+            ok = false;}}
+
+    fclose(fichier);
+    return ok;}
+
+
+// ajoute une ligne au message (tronquée si le message est plein)
+static void ajouter(char* message, size_t taille, size_t* n, const char* format, ...){
+
+    if (*n >= taille) return;
+    va_list args;
+    va_start(args, format);
+    int ecrits = vsnprintf(message + *n, taille - *n, format, args);
+    va_end(args);
+    if (ecrits > 0) *n += ecrits;}
+
+
+// le point touché au PC s'applique-t-il ?
+bool points_arreter(points_arret* p, int PC, int accumulateur, const mot* RAM, char* message, size_t taille){
+
+    size_t n = 0;
+    bool arret = false;
+    message[0] = '\0';
+
+    if (point_bit(p->execution, PC)){
+        unsigned char g = p->genre[PC];
+
+        // les passages ne comptent que si la condition est vraie
+        if ((g & POINT_INSTRUCTION) && ((p->condition[PC] < 0) || ((accumulateur & MASQUE_MOT) == p->condition[PC]))
+                && (++p->passages[PC] >= p->seuil[PC])){
+            ajouter(message, taille, &n, "Le point d'arrêt RAM[0x" HEX_ADRESSE "] est la mnémonique suivante (passage n°%lu).\n", PC, p->passages[PC]);
+            arret = true;}
+
+        if (g & POINT_ARGUMENT){
+            ajouter(message, taille, &n, "Le point d'arrêt RAM[0x" HEX_ADRESSE "] est l'argument de l'instruction suivante.\n", PC+1);
+            arret = true;}}
+
+    unsigned acces = acces_opcode[OPCODE(RAM[PC])];
+    int arg = ADRESSE(RAM[PC+1]), indirect = ADRESSE(RAM[arg]);
+
+    if ((acces & (ACCES_LIT | ACCES_LIT_IND)) && point_bit(p->lecture, arg)){
+        ajouter(message, taille, &n, "L'instruction suivante lit RAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT ".\n", arg, RAM[arg]);
+        arret = true;}
+    if ((acces & ACCES_LIT_IND) && point_bit(p->lecture, indirect)){
+        ajouter(message, taille, &n, "L'instruction suivante lit RAM[0x" HEX_ADRESSE "] = 0x" HEX_MOT ".\n", indirect, RAM[indirect]);
+        arret = true;}
+    if ((acces & ACCES_ECRIT) && point_bit(p->ecriture, arg)){
+        ajouter(message, taille, &n, "L'instruction suivante écrit RAM[0x" HEX_ADRESSE "] (actuellement 0x" HEX_MOT ").\n", arg, RAM[arg]);
+        arret = true;}
+    if ((acces & ACCES_ECRIT_IND) && point_bit(p->ecriture, indirect)){
+        ajouter(message, taille, &n, "L'instruction suivante écrit RAM[0x" HEX_ADRESSE "] (actuellement 0x" HEX_MOT ").\n", indirect, RAM[indirect]);
+        arret = true;}
+
+    return arret;}
@@ -0,0 +1,87 @@
+/* *******************************************************
+ * Nom           : points.h
+ * Rôle          : Points d'arrêt et points de surveillance du débogueur
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Autant de points que l'on veut, rangés dans des
+ *                 tableaux de TAILLE_RAM bits (un bit par adresse):
+ *                      - execution : arrêt quand le PC vaut l'adresse;
+ *                      - lecture / ecriture : arrêt avant une instruction
+ *                        qui lit / écrit RAM[adresse].
+ *                 À chaque cycle, points_touche() fait un test de bit
+ *                 pour le PC et au plus trois pour les données, quel que
+ *                 soit le nombre de points. Les conditions (valeur de
+ *                 l'accumulateur, nombre de passages) ne sont examinées
+ *                 qu'après un bit touché, par points_arreter().
+ *
+ *                 Commandes (ligne de commande, fichier -points ou
+ *                 stepper), adresses et valeurs en hexadécimal:
+ *                      break ADR [acc=V] [passage=N]
+ *                      watch ADR / rwatch ADR / wwatch ADR
+ *                      delete ADR
+ *
+ * ****************************************************** */
+
+#ifndef POINTS_H
+#define POINTS_H
+
+#include <stdint.h>
+#include "machine.h"
+
+// genre des points posés à une adresse (drapeaux)
+enum { POINT_INSTRUCTION = 1, POINT_ARGUMENT = 2, POINT_LECTURE = 4, POINT_ECRITURE = 8 };
+
+// tous les points du débogueur
+typedef struct {
+    uint64_t execution[TAILLE_RAM / 64]; // PC surveillés
+    uint64_t lecture[TAILLE_RAM / 64]; // adresses dont la lecture arrête
+    uint64_t ecriture[TAILLE_RAM / 64]; // adresses dont l'écriture arrête
+    unsigned char genre[TAILLE_RAM];
+    int condition[TAILLE_RAM]; // accumulateur attendu (un mot), -1 = aucune
+    unsigned long seuil[TAILLE_RAM]; // arrêt à partir du seuil-ième passage
+    unsigned long passages[TAILLE_RAM];
+    int nb; // points armés, 0 = aucun test dans la boucle
+} points_arret;
+
+// aucun point
+void points_init(points_arret* p);
+
+// ajoute des points (genre) à une adresse, sans condition
+void points_poser(points_arret* p, int adresse, int genre);
+
+// exécute une commande (break, watch, ...), NULL si elle est acceptée,
+// sinon le message d'erreur
+const char* points_commande(points_arret* p, const char* ligne);
+
+// exécute les commandes d'un fichier (une par ligne, # commentaire)
+// false si le fichier ne s'ouvre pas ou si une ligne est refusée
+bool points_fichier(points_arret* p, const char* chemin);
+
+// le point touché au PC s'applique-t-il ? (conditions, passages)
+// si oui, écrit la raison de l'arrêt dans message
+bool points_arreter(points_arret* p, int PC, int accumulateur, const mot* RAM, char* message, size_t taille);
+
+
+// bit adresse du tableau de TAILLE_RAM bits
+static inline bool point_bit(const uint64_t* bits, int adresse){
+    return (bits[adresse >> 6] >> (adresse & 63)) & 1;}
+
+
+// un point est-il touché par l'instruction en PC ? (avant exécution)
+static inline __attribute__((always_inline)) bool points_touche(const points_arret* p, int PC, const mot* RAM){
+
+    if (point_bit(p->execution, PC)) return true;
+
+    unsigned acces = acces_opcode[OPCODE(RAM[PC])];
+    if (!acces) return false;
+    int arg = ADRESSE(RAM[PC+1]), indirect = ADRESSE(RAM[arg]);
+    return ((acces & (ACCES_LIT | ACCES_LIT_IND)) && point_bit(p->lecture, arg))
+        || ((acces & ACCES_LIT_IND) && point_bit(p->lecture, indirect))
+        || ((acces & ACCES_ECRIT) && point_bit(p->ecriture, arg))
+        || ((acces & ACCES_ECRIT_IND) && point_bit(p->ecriture, indirect));}
+
+#endif
@@ -0,0 +1,148 @@
+/* *******************************************************
+ * Nom           : predecode.c
+ * Rôle          : Interpréteur prédécodé à threading direct
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Même sémantique que machine_executer(), sans switch:
+ *                 chaque instruction saute directement au code de la
+ *                 suivante (goto *cache[pc].gestionnaire). Les adresses
+ *                 hors de la fenêtre 0x20-0xFE (par défaut) ont une entrée "hors" qui
+ *                 arrête la machine: aucun test de bornes sur le PC.
+ *                 Le coeur (predecode_coeur.h) est compilé deux fois:
+ *                 sans crochet et avec les compteurs du profil.
+ *
+ *                 Superinstructions: suites les plus fréquentes dans les
+ *                 traces des programmes d'exemple (cx25_trace
+ *                 -sequences), pondérées par le nombre de cycles:
+ *                      STORE@ LOAD@          1026
+ *                      LOAD@ BRZ@             768
+ *                      SUB# STORE@            765
+ *                      LOAD@ ADD@ STORE@      764
+ *                      STORE@ JUMP@           516
+ *                 plus LOAD@ SUB# STORE@ BRZ@ (compteur de boucle). Le
+ *                 profil les garde: une superinstruction ne compte que
+ *                 ses sauts; seule une instruction dont le code a changé
+ *                 est comptée une à une, hors superinstruction.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include "predecode.h"
+
+// bit de l'adresse a dans une carte de TAILLE_RAM bits
+#define BIT(carte, a) ((carte)[(a) >> 6] & (1ULL << ((a) & 63)))
+
+
+// vide le cache (à appeler quand la RAM[] est rechargée)
+void predecode_init(cache_predecode* c){
+    c->initialise = false;}
+
+
+// garde le cache pour image si aucun mot décodé n'a changé (une entrée
+// valide ne lit que des mots marqués dans decodes)
+void predecode_recharger(cache_predecode* c, const mot* RAM, const mot* image){
+
+    int i;
+    if (!c->initialise) return;
+    for (i=0; i < TAILLE_RAM / 64; i++){
+        uint64_t bits = c->decodes[i];
+        while (bits){
+            int a = 64 * i + __builtin_ctzll(bits);
+            if (RAM[a] != image[a]) {predecode_init(c); return;}
+            bits &= bits - 1;}}}
+
+
+// invalide les entrées qui peuvent lire le byte a (opcode en a, argument
+// en a-1, superinstruction commencée jusqu'à 2*FUSION_MAX-1 bytes avant)
+static inline void invalider(cache_predecode* c, int a){
+
+    int b;
+    c->decodes[a >> 6] &= ~(1ULL << (a & 63));
+    for (b = a - 2 * FUSION_MAX + 1; b <= a; b++)
+        if (PC_VALIDE(b)) c->cache[b].gestionnaire = c->decoder;}
+
+
+// superinstructions, les plus longues d'abord
+typedef enum { FUSION_AUCUNE = -1, FUSION_LOAD_SUB_STORE_BRZ, FUSION_LOAD_ADD_STORE, FUSION_STORE_LOAD,
+    FUSION_LOAD_BRZ, FUSION_SUB_STORE, FUSION_STORE_JUMP, NB_FUSIONS } fusion;
+
+// suite d'opcodes de chaque superinstruction
+static const struct {
+    unsigned char opcodes[FUSION_MAX];
+    int longueur;
+} motifs[NB_FUSIONS] = {
+    [FUSION_LOAD_SUB_STORE_BRZ] = { { LOAD_AT, SUB_SHARP, STORE_AT, BRZ_AT }, 4 },
+    [FUSION_LOAD_ADD_STORE] = { { LOAD_AT, ADD_AT, STORE_AT }, 3 },
+    [FUSION_STORE_LOAD] = { { STORE_AT, LOAD_AT }, 2 },
+    [FUSION_LOAD_BRZ] = { { LOAD_AT, BRZ_AT }, 2 },
+    [FUSION_SUB_STORE] = { { SUB_SHARP, STORE_AT }, 2 },
+    [FUSION_STORE_JUMP] = { { STORE_AT, JUMP_AT }, 2 } };
+
+
+// superinstruction qui commence en PC (toutes ses instructions dans la
+// fenêtre), FUSION_AUCUNE sinon
+static fusion trouver_fusion(const mot* RAM, int PC){
+
+    int f, i;
+    for (f=0; f < NB_FUSIONS; f++){
+        if (!PC_VALIDE(PC + 2 * (motifs[f].longueur - 1))) continue;
+        for (i=0; (i < motifs[f].longueur) && (RAM[PC + 2*i] == motifs[f].opcodes[i]); i++);
+        if (i == motifs[f].longueur) return f;}
+    return FUSION_AUCUNE;}
+
+
+// version sans profil: aucun crochet
+#define PREDECODE_NOM executer_simple
+#define PROFIL_DEPART()
+#define PROFIL_EPUISE()
+#define PROFIL_SAUT(de)
+#define PROFIL_RESTE()
+#define PROFIL_ARRET()
+#define PROFIL_DECODE(a, opcode, argument) false
+#define PROFIL_FUSIONNABLE(PC, n) true
+#define PROFIL_COMPTE()
+#define PROFIL_LIT(a)
+#define PROFIL_ECRIT(a)
+#include "predecode_coeur.h"
+#undef PREDECODE_NOM
+#undef PROFIL_DEPART
+#undef PROFIL_EPUISE
+#undef PROFIL_SAUT
+#undef PROFIL_RESTE
+#undef PROFIL_ARRET
+#undef PROFIL_DECODE
+#undef PROFIL_FUSIONNABLE
+#undef PROFIL_COMPTE
+#undef PROFIL_LIT
+#undef PROFIL_ECRIT
+
+// version profilée: rien pour une instruction qui passe à PC+2, les
+// sauts (sorties seules) et les arrêts sont comptés, le reste est
+// déduit (profil.h)
+#define PREDECODE_NOM executer_profil
+#define PROFIL_DEPART() (p->entrees[PC]++)
+#define PROFIL_EPUISE() do { if (PC_VALIDE(PC)) p->entrees[PC]--; } while (0)
+#define PROFIL_SAUT(de) (p->sorties[de]++)
+#define PROFIL_RESTE() do { p->sorties[PC]++; p->entrees[PC]++; } while (0)
+#define PROFIL_ARRET() (p->sorties[PC]++)
+#define PROFIL_DECODE(a, opcode, argument) profil_decoder(p, a, opcode, argument)
+#define PROFIL_FUSIONNABLE(PC, n) profil_fusionnable(p, RAM, PC, n)
+#define PROFIL_COMPTE() (p->comptees[PC]++)
+#define PROFIL_LIT(a) (p->lectures[a]++)
+#define PROFIL_ECRIT(a) (p->ecritures[a]++)
+#include "predecode_coeur.h"
+
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire ou budget
+raison_arret predecode_executer(machine* m, cache_predecode* c, unsigned long budget){
+    return executer_simple(m, c, NULL, budget);}
+
+
+// même exécution en comptant dans le profil p (profil_solder avant de
+// le lire)
+raison_arret predecode_profiler(machine* m, cache_predecode* c, profil_execution* p, unsigned long budget){
+    return executer_profil(m, c, p, budget);}
@@ -0,0 +1,76 @@
+/* *******************************************************
+ * Nom           : predecode.h
+ * Rôle          : Interpréteur prédécodé à threading direct
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Chaque adresse de RAM[] a une entrée de cache qui
+ *                 contient l'adresse du code de son instruction (goto
+ *                 calculé de GCC) et son argument déjà lu. Une entrée
+ *                 n'est décodée qu'à sa première exécution.
+ *
+ *                 Code auto-modifié: une carte de TAILLE_RAM bits marque les
+ *                 bytes lus par une entrée décodée (opcode et argument).
+ *                 STORE@, STORE*@ et IN@ testent le bit de l'adresse
+ *                 écrite: s'il est mis, seules les entrées adresse et
+ *                 adresse-1 sont invalidées et seront redécodées.
+ *                 (IN*@ n'écrit rien dans cette machine.)
+ *
+ *                 Superinstructions: au décodage, une suite fréquente
+ *                 (LOAD@ ADD@ STORE@, STORE@ LOAD@, ...) reçoit un seul
+ *                 gestionnaire qui exécute et compte toutes ses
+ *                 instructions d'un coup. L'entrée lit alors jusqu'à
+ *                 2 * FUSION_MAX bytes: une écriture invalide les
+ *                 entrées adresse-2*FUSION_MAX+1 à adresse.
+ *
+ * ****************************************************** */
+
+#ifndef PREDECODE_H
+#define PREDECODE_H
+
+#include <stdint.h>
+#include "machine.h"
+#include "profil.h"
+
+// une entrée par adresse, plus PC = TAILLE_RAM (après une instruction en
+// TAILLE_RAM - 2, 0xFE par défaut)
+#define TAILLE_CACHE (TAILLE_RAM + 1)
+
+// instructions au plus dans une superinstruction
+#define FUSION_MAX 4
+
+// instruction prédécodée
+typedef struct {
+    const void* gestionnaire; // étiquette du code de l'instruction
+    mot argument; // RAM[pc+1] au décodage
+    mot suite[FUSION_MAX - 1]; // arguments des instructions fusionnées
+} entree_cache;
+
+// cache de prédécodage d'une machine
+typedef struct {
+    entree_cache cache[TAILLE_CACHE];
+    uint64_t decodes[TAILLE_RAM / 64]; // bytes lus par une entrée décodée
+    const void* decoder; // étiquette du décodeur (entrée invalide)
+    bool initialise;
+} cache_predecode;
+
+// vide le cache (à appeler quand la RAM[] est rechargée)
+void predecode_init(cache_predecode* c);
+
+// avant de recharger avec image une machine qui a tourné avec ce cache
+// (RAM[] en fin d'exécution): le cache est gardé si les mots lus par
+// ses entrées décodées sont les mêmes dans les deux, sinon il est vidé
+void predecode_recharger(cache_predecode* c, const mot* RAM, const mot* image);
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire ou budget
+// budget = nombre maximal de cycles, 0 = illimité
+raison_arret predecode_executer(machine* m, cache_predecode* c, unsigned long budget);
+
+// même exécution en comptant dans le profil p (-profile), cumulé d'un
+// appel à l'autre; profil_solder() avant de le lire
+raison_arret predecode_profiler(machine* m, cache_predecode* c, profil_execution* p, unsigned long budget);
+
+#endif
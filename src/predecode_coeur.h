@@ -0,0 +1,200 @@
+/* *******************************************************
+ * Nom           : predecode_coeur.h
+ * Rôle          : Coeur de l'interpréteur prédécodé (gabarit)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Inclus deux fois par predecode.c, qui définit avant
+ *                 l'inclusion:
+ *                      PREDECODE_NOM : nom de la fonction générée
+ *                      PROFIL_DEPART() : la machine repart du PC
+ *                      PROFIL_EPUISE() : le PC atteint n'est pas exécuté
+ *                      PROFIL_SAUT(de) : JUMP@, BRN@ ou BRZ@ de pris
+ *                      PROFIL_RESTE() : le PC ne bouge pas
+ *                      PROFIL_ARRET() : la machine s'arrête après PC
+ *                      PROFIL_DECODE(a, opcode, argument) : instruction
+ *                          a (re)décodée, vrai pour passer par compter
+ *                      PROFIL_FUSIONNABLE(PC, n) : faux si l'une des
+ *                          instructions 2 à n doit passer par compter
+ *                      PROFIL_COMPTE() : exécution du PC comptée une à une
+ *                      PROFIL_LIT(a) / PROFIL_ECRIT(a) : accès indirect
+ *                 Sans profil, ces crochets sont vides (DECODE faux,
+ *                 FUSIONNABLE vrai).
+ *
+ *                 Une superinstruction de n instructions compte n cycles.
+ *                 S'il en reste moins au budget, son entrée exécute sa
+ *                 première instruction seule. Si l'un de ses STORE@ écrit
+ *                 un byte décodé (peut-être le sien), elle rend les cycles
+ *                 non faits et repart de l'instruction suivante, redécodée
+ *                 au besoin.
+ *
+ * ****************************************************** */
+
+// exécute sans trace jusqu'à OUT, sortie de la mémoire ou budget
+static raison_arret PREDECODE_NOM(machine* m, cache_predecode* c, profil_execution* p, unsigned long budget){
+
+    // code de chaque opcode, les opcodes inconnus ne font rien
+    static const void* const gestionnaires[256] = { [0 ... 255] = &&inconnue,
+        [ADD_SHARP] = &&add_sharp, [ADD_AT] = &&add_at, [ADD_STAR_AT] = &&add_star_at,
+        [SUB_SHARP] = &&sub_sharp, [SUB_AT] = &&sub_at, [SUB_STAR_AT] = &&sub_star_at,
+        [NAND_SHARP] = &&nand_sharp, [NAND_AT] = &&nand_at, [NAND_STAR_AT] = &&nand_star_at,
+        [LOAD_SHARP] = &&load_sharp, [LOAD_AT] = &&load_at, [LOAD_STAR_AT] = &&load_star_at,
+        [STORE_AT] = &&store_at, [STORE_STAR_AT] = &&store_star_at,
+        [IN_AT] = &&in_at, [IN_STAR_AT] = &&in_star_at,
+        [OUT_SHARP] = &&out_sharp, [OUT_AT] = &&out_at, [OUT_STAR_AT] = &&out_star_at,
+        [JUMP_AT] = &&jump_at, [BRN_AT] = &&brn_at, [BRZ_AT] = &&brz_at };
+
+    // code de chaque superinstruction (predecode.c)
+    static const void* const fusions[NB_FUSIONS] = {
+        [FUSION_LOAD_SUB_STORE_BRZ] = &&load_sub_store_brz, [FUSION_LOAD_ADD_STORE] = &&load_add_store,
+        [FUSION_STORE_LOAD] = &&store_load, [FUSION_LOAD_BRZ] = &&load_brz,
+        [FUSION_SUB_STORE] = &&sub_store, [FUSION_STORE_JUMP] = &&store_jump };
+    fusion f;
+    int i;
+
+    mot* RAM = m->RAM;
+    entree_cache* cache = c->cache;
+    int PC = m->PC, accumulateur = m->accumulateur, a, n;
+    unsigned long limite = budget ? m->compteur + budget : (unsigned long) -1;
+    unsigned long restant = limite - m->compteur;
+
+    // premier appel (ou cache rempli par l'autre version): entrées à
+    // décoder dans la fenêtre, "hors" ailleurs
+    if ((!c->initialise) || (c->decoder != &&decoder)){
+        int i;
+        c->decoder = &&decoder;
+        for (i=0; i < TAILLE_CACHE; i++) cache[i].gestionnaire = PC_VALIDE(i) ? &&decoder : &&hors;
+        memset(c->decodes, 0, sizeof(c->decodes));
+        c->initialise = true;}
+
+    m->raison = ARRET_AUCUN;
+    if (!PC_VALIDE(PC)) return m->raison = ARRET_PC;
+    PROFIL_DEPART();
+
+// passe à l'instruction en PC (un cycle de plus)
+#define SUIVANTE() do { if (restant == 0) goto epuise; restant--; goto *cache[PC].gestionnaire; } while (0)
+
+// une écriture dans RAM[a] invalide les entrées qui lisent ce byte
+#define ECRIRE(a, valeur) do { RAM[a] = (valeur); if (BIT(c->decodes, a)) invalider(c, a); } while (0)
+
+    SUIVANTE();
+
+    decoder: // première exécution ou code modifié
+    cache[PC].argument = RAM[PC+1];
+    n = 1;
+    if (PROFIL_DECODE(PC, RAM[PC], RAM[PC+1])) cache[PC].gestionnaire = &&compter;
+    else if (((f = trouver_fusion(RAM, PC)) != FUSION_AUCUNE) && PROFIL_FUSIONNABLE(PC, motifs[f].longueur)){
+        cache[PC].gestionnaire = fusions[f];
+        n = motifs[f].longueur;
+        for (i=1; i < n; i++) cache[PC].suite[i-1] = RAM[PC + 2*i + 1];}
+    else cache[PC].gestionnaire = gestionnaires[OPCODE(RAM[PC])];
+    for (a = PC; a < PC + 2*n; a++) c->decodes[a >> 6] |= 1ULL << (a & 63);
+    goto *cache[PC].gestionnaire;
+
+    compter: // profil: instruction dont le code a changé
+    PROFIL_COMPTE();
+    goto *gestionnaires[OPCODE(RAM[PC])];
+
+    add_sharp: accumulateur += cache[PC].argument; PC += 2; SUIVANTE();
+    add_at: accumulateur += CASE(RAM, cache[PC].argument); PC += 2; SUIVANTE();
+    add_star_at: a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_LIT(a); accumulateur += RAM[a]; PC += 2; SUIVANTE();
+
+    sub_sharp: accumulateur -= cache[PC].argument; PC += 2; SUIVANTE();
+    sub_at: accumulateur -= CASE(RAM, cache[PC].argument); PC += 2; SUIVANTE();
+    sub_star_at: a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_LIT(a); accumulateur -= RAM[a]; PC += 2; SUIVANTE();
+
+    nand_sharp: accumulateur = ~(accumulateur & cache[PC].argument); PC += 2; SUIVANTE();
+    nand_at: accumulateur = ~(accumulateur & CASE(RAM, cache[PC].argument)); PC += 2; SUIVANTE();
+    nand_star_at: a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_LIT(a); accumulateur = ~(accumulateur & RAM[a]); PC += 2; SUIVANTE();
+
+    load_sharp: accumulateur = cache[PC].argument; PC += 2; SUIVANTE();
+    load_at: accumulateur = CASE(RAM, cache[PC].argument); PC += 2; SUIVANTE();
+    load_star_at: a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_LIT(a); accumulateur = RAM[a]; PC += 2; SUIVANTE();
+
+    store_at: a = ADRESSE(cache[PC].argument); ECRIRE(a, accumulateur); PC += 2; SUIVANTE();
+    store_star_at: a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_ECRIT(a); ECRIRE(a, accumulateur); PC += 2; SUIVANTE();
+
+    in_at: { // lit l'entrée puis invalide comme un STORE@
+        mot valeur;
+        a = ADRESSE(cache[PC].argument);
+        if (!lire_entree(m, &valeur)) {PROFIL_ARRET(); m->raison = ARRET_ENTREE; goto fin;}
+        ECRIRE(a, valeur);
+        if (!m->entrees_tampon) vider_ligne(); // vide buffer pour stepper
+        PC += 2; SUIVANTE();}
+
+    in_star_at: // la ligne est consommée, rien n'est stocké
+    if (!m->entrees_tampon) vider_ligne();
+    else if (m->pos_entree < m->nb_entrees) m->pos_entree++;
+    PC += 2; SUIVANTE();
+
+    out_sharp: PROFIL_ARRET(); m->resultat = cache[PC].argument; m->raison = ARRET_OUT; goto fin;
+    out_at: PROFIL_ARRET(); m->resultat = CASE(RAM, cache[PC].argument); m->raison = ARRET_OUT; goto fin;
+    out_star_at: PROFIL_ARRET(); a = ADRESSE(CASE(RAM, cache[PC].argument)); PROFIL_LIT(a); m->resultat = RAM[a]; m->raison = ARRET_OUT; PC += 2; goto fin;
+
+    jump_at: PROFIL_SAUT(PC); PC = ADRESSE(cache[PC].argument); SUIVANTE();
+    brn_at: if (accumulateur & BIT_SIGNE) {PROFIL_SAUT(PC); PC = ADRESSE(cache[PC].argument);} else PC += 2; SUIVANTE();
+    brz_at: if (accumulateur == 0) {PROFIL_SAUT(PC); PC = ADRESSE(cache[PC].argument);} else PC += 2; SUIVANTE();
+
+    inconnue: PROFIL_RESTE(); SUIVANTE(); // instruction non reconnue: le PC ne bouge pas
+
+// n instructions d'un coup si le budget le permet (une déjà comptée),
+// sinon la première seule
+#define FUSION(n, premiere) do { if (restant < (n) - 1) goto premiere; restant -= (n) - 1; } while (0)
+
+// STORE@ en k-ième instruction d'une fusion de n: si le byte écrit est
+// décodé, les instructions suivantes repartent une par une
+#define RANGER(a, k, n) do { RAM[a] = accumulateur; \
+    if (BIT(c->decodes, a)) {invalider(c, a); restant += (n) - (k); PC += 2 * (k); SUIVANTE();} } while (0)
+
+    load_sub_store_brz: FUSION(4, load_at);
+    accumulateur = CASE(RAM, cache[PC].argument) - cache[PC].suite[0];
+    a = ADRESSE(cache[PC].suite[1]); RANGER(a, 3, 4);
+    if (accumulateur == 0) {PROFIL_SAUT(PC + 6); PC = ADRESSE(cache[PC].suite[2]);}
+    else PC += 8;
+    SUIVANTE();
+
+    load_add_store: FUSION(3, load_at);
+    accumulateur = CASE(RAM, cache[PC].argument) + CASE(RAM, cache[PC].suite[0]);
+    a = ADRESSE(cache[PC].suite[1]); RANGER(a, 3, 3);
+    PC += 6; SUIVANTE();
+
+    store_load: FUSION(2, store_at);
+    a = ADRESSE(cache[PC].argument); RANGER(a, 1, 2);
+    accumulateur = CASE(RAM, cache[PC].suite[0]); PC += 4; SUIVANTE();
+
+    load_brz: FUSION(2, load_at);
+    accumulateur = CASE(RAM, cache[PC].argument);
+    if (accumulateur == 0) {PROFIL_SAUT(PC + 2); PC = ADRESSE(cache[PC].suite[0]);}
+    else PC += 4;
+    SUIVANTE();
+
+    sub_store: FUSION(2, sub_sharp);
+    accumulateur -= cache[PC].argument;
+    a = ADRESSE(cache[PC].suite[0]); RANGER(a, 2, 2);
+    PC += 4; SUIVANTE();
+
+    store_jump: FUSION(2, store_at);
+    a = ADRESSE(cache[PC].argument); RANGER(a, 1, 2);
+    PROFIL_SAUT(PC + 2); PC = ADRESSE(cache[PC].suite[0]); SUIVANTE();
+
+#undef FUSION
+#undef RANGER
+
+    hors: // le PC a quitté la fenêtre: ce n'était pas un cycle
+    restant++;
+    m->raison = ARRET_PC; goto fin;
+
+    epuise: // budget atteint (sauf si le PC est déjà hors de la fenêtre)
+    m->raison = PC_VALIDE(PC) ? ARRET_BUDGET : ARRET_PC;
+    PROFIL_EPUISE();
+
+    fin:
+    m->PC = PC; m->accumulateur = accumulateur; m->compteur = limite - restant;
+    return m->raison;
+
+#undef SUIVANTE
+#undef ECRIRE
+}
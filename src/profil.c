@@ -0,0 +1,171 @@
+/* *******************************************************
+ * Nom           : profil.c
+ * Rôle          : Profil d'exécution (rapports)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Rapport JSON (adresses, opcodes, branchements,
+ *                 mémoire, boucles chaudes) et piles repliées
+ *                 ("programme;boucle 0x30-0x38;0x32 SUB# 1234") que
+ *                 flamegraph.pl transforme en flame graph.
+ *
+ *                 Une boucle est un saut pris vers l'arrière (JUMP@,
+ *                 BRN@ ou BRZ@ de fin vers debut <= fin), sauf le saut
+ *                 unique vers l'instruction où la machine s'est arrêtée
+ *                 (sortie placée avant le code). Ses cycles sont ceux
+ *                 des adresses de debut à fin.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include "profil.h"
+
+// un arc arrière pris
+typedef struct {
+    int debut, fin;
+    uint64_t iterations;
+    uint64_t cycles;
+} boucle;
+
+
+// compteurs à zéro
+void profil_init(profil_execution* p){
+    memset(p, 0, sizeof(*p));
+    p->triees = true;}
+
+
+// nom de l'opcode, "inconnue" s'il n'en a pas
+static const char* nom(int opcode){
+    return nom_mnemonique[OPCODE(opcode)] ? nom_mnemonique[OPCODE(opcode)] : "inconnue";}
+
+
+// les plus chaudes d'abord
+static int par_cycles(const void* a, const void* b){
+    const boucle *x = a, *y = b;
+    if (x->cycles != y->cycles) return (x->cycles < y->cycles) ? 1 : -1;
+    return x->debut - y->debut;}
+
+
+// les plus larges (extérieures) d'abord
+static int par_etendue(const void* a, const void* b){
+    const boucle *x = a, *y = b;
+    if (x->fin - x->debut != y->fin - y->debut) return (y->fin - y->debut) - (x->fin - x->debut);
+    return x->debut - y->debut;}
+
+
+// boucles du profil, renvoie leur nombre
+static int trouver_boucles(const profil_execution* p, const machine* m, boucle* boucles){
+
+    int PC, a, n = 0;
+    for (PC=0; PC < TAILLE_RAM; PC++){
+        int op = p->opcode[PC];
+        if ((p->prises[PC] == 0) || (ADRESSE(p->argument[PC]) > PC) || ((op != JUMP_AT) && (op != BRN_AT) && (op != BRZ_AT))) continue;
+        if ((p->prises[PC] == 1) && (m->PC >= ADRESSE(p->argument[PC])) && (m->PC <= ADRESSE(p->argument[PC]) + 2)) continue;
+        boucle* b = &boucles[n++];
+        b->debut = ADRESSE(p->argument[PC]);
+        b->fin = PC;
+        b->iterations = p->prises[PC];
+        b->cycles = 0;
+        for (a = b->debut; a <= b->fin; a++) b->cycles += p->executions[a];}
+    return n;}
+
+
+// nom du programme sans les caractères réservés (JSON et piles)
+static void nettoyer(char* propre, size_t taille, const char* programme){
+
+    size_t i;
+    for (i=0; (i+1 < taille) && programme[i]; i++){
+        char c = programme[i];
+        propre[i] = ((c == ';') || (c == ' ') || (c == '"') || (c == '\\') || ((unsigned char) c < 0x20)) ? '_' : c;}
+    propre[i] = '\0';}
+
+
+// rapport JSON
+static void ecrire_json(FILE* f, const profil_execution* p, const machine* m, const char* programme, boucle* boucles, int nb_boucles){
+
+    int a, i;
+    const char* separateur = "";
+
+    fprintf(f, "{\n  \"programme\": \"%s\",\n  \"cycles\": %lu,\n  \"raison\": \"%s\",\n", programme, m->compteur, nom_raison[m->raison]);
+    if (m->raison == ARRET_OUT) fprintf(f, "  \"resultat\": \"0x" HEX_MOT "\",\n", m->resultat);
+    else fprintf(f, "  \"resultat\": null,\n");
+
+    fprintf(f, "  \"adresses\": [");
+    for (a=0; a < TAILLE_RAM; a++){
+        if (!p->executions[a]) continue;
+        fprintf(f, "%s\n    {\"adresse\": \"0x" HEX_ADRESSE "\", \"mnemonique\": \"%s\", \"executions\": %lu}", separateur, a, nom(p->opcode[a]), (unsigned long) p->executions[a]);
+        separateur = ",";}
+    fprintf(f, "\n  ],\n");
+
+    separateur = "";
+    fprintf(f, "  \"opcodes\": [");
+    for (a=0; a < 256; a++){
+        if (!p->opcodes[a]) continue;
+        fprintf(f, "%s\n    {\"opcode\": \"0x%02x\", \"mnemonique\": \"%s\", \"executions\": %lu}", separateur, a, nom(a), (unsigned long) p->opcodes[a]);
+        separateur = ",";}
+    fprintf(f, "\n  ],\n");
+
+    separateur = "";
+    fprintf(f, "  \"branchements\": [");
+    for (a=0; a < TAILLE_RAM; a++){
+        if ((!p->executions[a]) || ((p->opcode[a] != BRN_AT) && (p->opcode[a] != BRZ_AT))) continue;
+        uint64_t n = p->executions[a], pris = p->prises[a];
+        fprintf(f, "%s\n    {\"adresse\": \"0x" HEX_ADRESSE "\", \"mnemonique\": \"%s\", \"cible\": \"0x" HEX_MOT "\", \"executions\": %lu, \"pris\": %lu, \"non_pris\": %lu, \"taux_pris\": %.4f}",
+            separateur, a, nom(p->opcode[a]), p->argument[a], (unsigned long) n, (unsigned long) pris, (unsigned long) (n - pris), (double) pris / n);
+        separateur = ",";}
+    fprintf(f, "\n  ],\n");
+
+    separateur = "";
+    fprintf(f, "  \"memoire\": [");
+    for (a=0; a < TAILLE_RAM; a++){
+        if ((!p->lectures[a]) && (!p->ecritures[a])) continue;
+        fprintf(f, "%s\n    {\"adresse\": \"0x" HEX_ADRESSE "\", \"lectures\": %lu, \"ecritures\": %lu}", separateur, a, (unsigned long) p->lectures[a], (unsigned long) p->ecritures[a]);
+        separateur = ",";}
+    fprintf(f, "\n  ],\n");
+
+    separateur = "";
+    fprintf(f, "  \"boucles\": [");
+    for (i=0; (i < nb_boucles) && (i < PROFIL_BOUCLES); i++){
+        fprintf(f, "%s\n    {\"debut\": \"0x" HEX_ADRESSE "\", \"fin\": \"0x" HEX_ADRESSE "\", \"iterations\": %lu, \"cycles\": %lu, \"part\": %.4f}", separateur,
+            boucles[i].debut, boucles[i].fin, (unsigned long) boucles[i].iterations, (unsigned long) boucles[i].cycles,
+            m->compteur ? (double) boucles[i].cycles / m->compteur : 0.0);
+        separateur = ",";}
+    fprintf(f, "\n  ]\n}\n");}
+
+
+// piles repliées: programme, boucles englobantes (extérieure d'abord), adresse
+static void ecrire_piles(FILE* f, const profil_execution* p, const char* programme, boucle* boucles, int nb_boucles){
+
+    int a, i;
+    qsort(boucles, nb_boucles, sizeof(boucle), par_etendue);
+
+    for (a=0; a < TAILLE_RAM; a++){
+        if (!p->executions[a]) continue;
+        fprintf(f, "%s", programme);
+        for (i=0; i < nb_boucles; i++)
+            if ((boucles[i].debut <= a) && (a <= boucles[i].fin)) fprintf(f, ";boucle 0x" HEX_ADRESSE "-0x" HEX_ADRESSE, boucles[i].debut, boucles[i].fin);
+        fprintf(f, ";0x" HEX_ADRESSE " %s %lu\n", a, nom(p->opcode[a]), (unsigned long) p->executions[a]);}}
+
+
+// écrit le rapport JSON et les piles repliées
+bool profil_ecrire(const profil_execution* p, const machine* m, const char* programme, const char* chemin_json, const char* chemin_piles){
+
+    boucle boucles[TAILLE_RAM];
+    int nb_boucles = trouver_boucles(p, m, boucles);
+    qsort(boucles, nb_boucles, sizeof(boucle), par_cycles);
+
+    char propre[256];
+    nettoyer(propre, sizeof(propre), programme);
+
+    FILE* json = fopen(chemin_json, "w");
+    if (!json) return false;
+    ecrire_json(json, p, m, propre, boucles, nb_boucles);
+    if (fclose(json) != 0) return false;
+
+    FILE* piles = fopen(chemin_piles, "w");
+    if (!piles) return false;
+    ecrire_piles(piles, p, propre, boucles, nb_boucles);
+    return fclose(piles) == 0;}
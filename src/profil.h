@@ -0,0 +1,199 @@
+/* *******************************************************
+ * Nom           : profil.h
+ * Rôle          : Profil d'exécution (compteurs par adresse)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Tableaux plats indexés par le PC ou l'adresse:
+ *                 exécutions par adresse, histogramme des opcodes,
+ *                 branchements pris, lectures et écritures de RAM[].
+ *
+ *                 Boucle de cx25.1 (avec d'autres options):
+ *                 profil_cycle() compte tout à chaque cycle.
+ *
+ *                 Interpréteur prédécodé (superinstructions comprises):
+ *                 une instruction qui passe à PC+2 ne compte rien.
+ *                 Seuls les départs (entrees) et les instructions qui
+ *                 ne passent pas à PC+2 (sorties: saut pris, arrêt)
+ *                 sont comptés. La cible d'un JUMP@, BRN@ ou BRZ@ ne
+ *                 change pas avec l'époque (plus bas): ses sorties
+ *                 donnent les entrees de la cible et les branchements
+ *                 pris. D'où, une seule fois avant le rapport
+ *                 (profil_solder):
+ *                      executions[a] = entrees[a] + executions[a-2]
+ *                                      - sorties[a-2]
+ *                 Le reste se déduit par "époque": tant que l'opcode et
+ *                 l'argument d'une adresse ne changent pas, chaque
+ *                 exécution a les mêmes accès. L'époque s'ouvre au
+ *                 premier décodage qui couvre l'adresse (aucune
+ *                 exécution avant) et son solde est reporté au
+ *                 rapport. Une adresse dont le code change (code
+ *                 auto-modifié) est ensuite comptée une à une
+ *                 (comptees), sans superinstruction: ses époques se
+ *                 ferment au redécodage sans calcul, la première est
+ *                 soldée au rapport (executions - comptees). Seules les
+ *                 adresses de la liste ouvertes[] sont visitées. Un
+ *                 profil est rempli par l'une ou l'autre boucle, pas
+ *                 les deux.
+ *
+ *                 Rapport (profil.c): JSON et piles repliées pour les
+ *                 flame graphs, les boucles chaudes étant trouvées par
+ *                 les sauts pris vers l'arrière.
+ *
+ * ****************************************************** */
+
+#ifndef PROFIL_H
+#define PROFIL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "machine.h"
+
+// boucles les plus chaudes gardées dans le rapport JSON
+#define PROFIL_BOUCLES 10
+
+// état d'une adresse dans l'interpréteur prédécodé
+enum { PROFIL_OUVERTE = 1, PROFIL_COMPTEE = 2, PROFIL_AVANT = 4 };
+
+// compteurs d'une exécution
+typedef struct {
+    uint64_t executions[TAILLE_RAM]; // cycles par PC
+    uint64_t opcodes[256]; // cycles par opcode
+    uint64_t prises[TAILLE_RAM]; // JUMP@, BRN@, BRZ@ pris, par PC
+    uint64_t lectures[TAILLE_RAM]; // lectures de chaque mot de RAM[]
+    uint64_t ecritures[TAILLE_RAM];
+    mot opcode[TAILLE_RAM]; // dernière instruction vue en PC
+    mot argument[TAILLE_RAM];
+    // interpréteur prédécodé seulement
+    uint64_t entrees[TAILLE_RAM]; // arrivées autrement que de PC-2
+    uint64_t sorties[TAILLE_RAM]; // exécutions non suivies de PC+2
+    uint64_t sorties_depuis[TAILLE_RAM]; // sorties au début de l'époque
+    uint64_t comptees[TAILLE_RAM]; // exécutions une à une (code modifié)
+    uint64_t depuis[TAILLE_RAM]; // début de l'époque: executions, ou comptees
+    uint64_t depuis_avant[TAILLE_RAM]; // première époque d'une adresse comptée
+    mot opcode_avant[TAILLE_RAM]; // et son instruction
+    mot argument_avant[TAILLE_RAM];
+    unsigned char etat[TAILLE_RAM]; // PROFIL_OUVERTE, PROFIL_COMPTEE, PROFIL_AVANT
+    int ouvertes[TAILLE_RAM]; // adresses dont l'époque est ouverte
+    int nb_ouvertes;
+    bool triees; // ouvertes[] par adresses croissantes
+} profil_execution;
+
+// compteurs à zéro
+void profil_init(profil_execution* p);
+
+// écrit le rapport JSON et les piles repliées, false si erreur (errno)
+bool profil_ecrire(const profil_execution* p, const machine* m, const char* programme, const char* chemin_json, const char* chemin_piles);
+
+
+// n exécutions de l'instruction (opcode, argument) en PC: tout ce qui
+// ne dépend pas de la RAM[] au moment du cycle
+static inline __attribute__((always_inline)) void profil_compter(profil_execution* p, int PC, int opcode, int argument, uint64_t n){
+
+    unsigned acces = acces_opcode[OPCODE(opcode)];
+    p->opcodes[OPCODE(opcode)] += n;
+    if (acces & (ACCES_LIT | ACCES_LIT_IND)) p->lectures[ADRESSE(argument)] += n;
+    if (acces & ACCES_ECRIT) p->ecritures[ADRESSE(argument)] += n;
+    if (opcode == JUMP_AT) p->prises[PC] += n;}
+
+
+// sauts de l'époque en a (instruction opcode, argument) depuis son
+// début: les sorties d'un JUMP@, BRN@ ou BRZ@ vont à son argument
+static inline void profil_sauts(profil_execution* p, int a, int opcode, int argument){
+
+    uint64_t n = p->sorties[a] - p->sorties_depuis[a];
+    p->sorties_depuis[a] = p->sorties[a];
+    if ((opcode != JUMP_AT) && (opcode != BRN_AT) && (opcode != BRZ_AT)) return;
+    p->entrees[ADRESSE(argument)] += n;
+    if (opcode != JUMP_AT) p->prises[a] += n;} // JUMP@: profil_compter()
+
+
+// profil_decoder() hors du cas courant (même instruction qu'avant)
+static __attribute__((noinline, cold)) bool profil_redecoder(profil_execution* p, int a, int opcode, int argument){
+
+    unsigned char e = p->etat[a];
+    if (!(e & PROFIL_OUVERTE)){
+        p->etat[a] = PROFIL_OUVERTE;
+        p->opcode[a] = opcode;
+        p->argument[a] = argument;
+        p->depuis[a] = 0;
+        if ((p->nb_ouvertes > 0) && (p->ouvertes[p->nb_ouvertes - 1] > a)) p->triees = false;
+        p->ouvertes[p->nb_ouvertes++] = a;
+        return false;}
+    profil_sauts(p, a, p->opcode[a], p->argument[a]);
+    if (e & PROFIL_COMPTEE) profil_compter(p, a, p->opcode[a], p->argument[a], p->comptees[a] - p->depuis[a]);
+    else { // exécutions de la première époque inconnues ici: soldée à la fin
+        p->etat[a] |= PROFIL_COMPTEE | PROFIL_AVANT;
+        p->opcode_avant[a] = p->opcode[a];
+        p->argument_avant[a] = p->argument[a];
+        p->depuis_avant[a] = p->depuis[a];}
+    p->opcode[a] = opcode;
+    p->argument[a] = argument;
+    p->depuis[a] = p->comptees[a];
+    return true;}
+
+
+// entrée décodée qui exécute l'instruction (opcode, argument) en a: la
+// première fois, l'époque s'ouvre; si le code a changé, l'adresse est
+// désormais comptée une à une et l'époque passe à la nouvelle
+// instruction. Vrai si l'adresse est comptée une à une.
+static inline bool profil_decoder(profil_execution* p, int a, int opcode, int argument){
+
+    if ((p->etat[a] & PROFIL_OUVERTE) && (p->opcode[a] == opcode) && (p->argument[a] == argument)) return p->etat[a] & PROFIL_COMPTEE;
+    return profil_redecoder(p, a, opcode, argument);}
+
+
+// instructions 2 à n d'une superinstruction décodée en PC (époques comme
+// au décodage); faux si l'une est comptée une à une
+static inline bool profil_fusionnable(profil_execution* p, const mot* RAM, int PC, int n){
+
+    bool fusionnable = true;
+    int i;
+    for (i=1; i < n; i++)
+        if (profil_decoder(p, PC + 2*i, RAM[PC + 2*i], RAM[PC + 2*i + 1])) fusionnable = false;
+    return fusionnable;}
+
+
+// ordre croissant des adresses
+static inline int profil_ordre(const void* x, const void* y){
+    return *(const int*) x - *(const int*) y;}
+
+
+// avant de lire un profil prédécodé: executions[] des adresses ouvertes
+// (par adresses croissantes) et solde de leurs époques, qui restent
+// ouvertes; sans effet sur un profil de profil_cycle()
+static inline void profil_solder(profil_execution* p){
+
+    int i;
+    if (!p->triees) {qsort(p->ouvertes, p->nb_ouvertes, sizeof(int), profil_ordre); p->triees = true;}
+    for (i=0; i < p->nb_ouvertes; i++) profil_sauts(p, p->ouvertes[i], p->opcode[p->ouvertes[i]], p->argument[p->ouvertes[i]]);
+    for (i=0; i < p->nb_ouvertes; i++){
+        int a = p->ouvertes[i];
+        uint64_t fin;
+        p->executions[a] = p->entrees[a];
+        if (PC_VALIDE(a-2) && (p->etat[a-2] & PROFIL_OUVERTE)) p->executions[a] += p->executions[a-2] - p->sorties[a-2];
+        if (p->etat[a] & PROFIL_AVANT){
+            profil_compter(p, a, p->opcode_avant[a], p->argument_avant[a], p->executions[a] - p->comptees[a] - p->depuis_avant[a]);
+            p->etat[a] &= ~PROFIL_AVANT;}
+        fin = (p->etat[a] & PROFIL_COMPTEE) ? p->comptees[a] : p->executions[a];
+        profil_compter(p, a, p->opcode[a], p->argument[a], fin - p->depuis[a]);
+        p->depuis[a] = fin;}}
+
+
+// un cycle de la boucle de cx25.1, avant l'exécution de l'instruction
+static inline __attribute__((always_inline)) void profil_cycle(profil_execution* p, int PC, const mot* RAM, int accumulateur){
+
+    int opcode = RAM[PC], argument = RAM[PC+1];
+    unsigned acces = acces_opcode[OPCODE(opcode)];
+    p->executions[PC]++;
+    p->opcode[PC] = opcode;
+    p->argument[PC] = argument;
+    profil_compter(p, PC, opcode, argument, 1);
+    if (acces & ACCES_LIT_IND) p->lectures[ADRESSE(CASE(RAM, argument))]++;
+    if (acces & ACCES_ECRIT_IND) p->ecritures[ADRESSE(CASE(RAM, argument))]++;
+    if (((opcode == BRN_AT) && (accumulateur & BIT_SIGNE)) || ((opcode == BRZ_AT) && (accumulateur == 0))) p->prises[PC]++;}
+
+#endif
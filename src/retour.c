@@ -0,0 +1,199 @@
+/* *******************************************************
+ * Nom           : retour.c
+ * Rôle          : Exécution à rebours pour le stepper
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Anneau d'annulations + instantanés périodiques.
+ *                 Chaque déplacement coûte un nombre de cycles de l'ordre
+ *                 de la distance parcourue (au plus un intervalle de
+ *                 ré-exécution en plus), jamais toute l'exécution.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include "retour.h"
+
+
+// historique vide, un instantané tous les intervalle cycles
+void historique_init(historique* h, unsigned long intervalle){
+
+    memset(h, 0, sizeof(*h));
+    h->intervalle = intervalle ? intervalle : INTERVALLE_INSTANTANES;
+    h->annulations = malloc(NB_ANNULATIONS * sizeof(annulation));
+    h->instantanes = malloc(NB_INSTANTANES * sizeof(instantane));
+    if (!h->annulations || !h->instantanes) {
+        perror("allocation de l'historique (historique_init)");
+        exit(EXIT_FAILURE);}}
+
+
+void historique_liberer(historique* h){
+    free(h->annulations); free(h->instantanes); free(h->entrees); free(h->passages);}
+
+
+// garde un instantané sur deux (le premier, au cycle 0, reste)
+static void eclaircir(historique* h){
+
+    int i;
+    for (i=0; 2*i < h->nb_instantanes; i++) h->instantanes[i] = h->instantanes[2*i];
+    h->nb_instantanes = i;
+    h->intervalle *= 2;}
+
+
+// avant d'exécuter le cycle m->compteur + 1
+void historique_avant(historique* h, machine* m){
+
+    unsigned long c = m->compteur;
+    mot* RAM = m->RAM;
+    int PC = m->PC;
+
+    // instantané (une seule fois par cycle, même après un retour)
+    if ((c % h->intervalle == 0) && ((h->nb_instantanes == 0) || (h->instantanes[h->nb_instantanes-1].compteur < c))){
+        if (h->nb_instantanes == NB_INSTANTANES) eclaircir(h);
+        if (c % h->intervalle == 0){
+            instantane* s = &h->instantanes[h->nb_instantanes++];
+            s->compteur = c; s->PC = PC; s->accumulateur = m->accumulateur;
+            s->pos_entree = m->pos_entree;
+            memcpy(s->RAM, RAM, sizeof(s->RAM));}}
+
+    // annulation du cycle, l'anneau oublie le plus ancien
+    if (c - h->plus_ancien >= NB_ANNULATIONS) h->plus_ancien = c - NB_ANNULATIONS + 1;
+    annulation* a = h->courante = &h->annulations[c % NB_ANNULATIONS];
+    a->accumulateur = m->accumulateur;
+    a->PC = PC;
+    a->drapeaux = 0;
+    switch (RAM[PC]){
+        case STORE_AT: a->adresse = ADRESSE(RAM[PC+1]); a->drapeaux = ANNULER_ECRITURE; break;
+        case STORE_STAR_AT: a->adresse = ADRESSE(CASE(RAM, RAM[PC+1])); a->drapeaux = ANNULER_ECRITURE; break;
+        case IN_AT: a->adresse = ADRESSE(RAM[PC+1]); a->drapeaux = ANNULER_ECRITURE | ANNULER_ENTREE; break;
+        case IN_STAR_AT: a->adresse = 0; a->drapeaux = ANNULER_ENTREE; break;
+        default: a->adresse = 0; break;}
+    a->ancienne = RAM[a->adresse];
+
+    // entrées déjà données: relues dans l'historique, sinon au clavier
+    m->entrees = h->entrees;
+    m->nb_entrees = h->nb_entrees;
+    m->entrees_tampon = (m->pos_entree < h->nb_entrees);}
+
+
+// après le cycle: garde la valeur lue au clavier par IN@ / IN*@
+void historique_apres(historique* h, machine* m){
+
+    annulation* a = h->courante;
+    if (!(a->drapeaux & ANNULER_ENTREE) || m->entrees_tampon) return;
+
+    if (h->nb_entrees == h->capacite_entrees){
+        h->capacite_entrees = h->capacite_entrees ? 2 * h->capacite_entrees : 64;
+        h->entrees = realloc(h->entrees, h->capacite_entrees * sizeof(mot));
+        if (!h->entrees) {
+            perror("allocation des entrées (historique_apres)");
+            exit(EXIT_FAILURE);}}
+
+    // IN*@ ne stocke rien: la ligne consommée compte quand même
+    h->entrees[h->nb_entrees++] = (a->drapeaux & ANNULER_ECRITURE) ? m->RAM[a->adresse] : 0;
+    m->pos_entree++;}
+
+
+// défait le dernier cycle exécuté (il doit être dans l'anneau)
+static void annuler(historique* h, machine* m){
+
+    const annulation* a = &h->annulations[(m->compteur - 1) % NB_ANNULATIONS];
+    if (a->drapeaux & ANNULER_ECRITURE) m->RAM[a->adresse] = a->ancienne;
+    if (a->drapeaux & ANNULER_ENTREE) m->pos_entree--;
+    m->PC = a->PC;
+    m->accumulateur = a->accumulateur;
+    m->compteur--;}
+
+
+// un cycle en avant sans trace, false si la machine s'arrêterait
+static bool avancer(historique* h, machine* m){
+
+    int op = m->RAM[m->PC];
+    if (!PC_VALIDE(m->PC) || (op == OUT_SHARP) || (op == OUT_AT) || (op == OUT_STAR_AT)) return false;
+    historique_avant(h, m);
+    executer_instruction(m, &m->PC, &m->accumulateur, false);
+    m->compteur++;
+    historique_apres(h, m);
+    return true;}
+
+
+// repart du dernier instantané d'au plus cible cycles
+static void restaurer(historique* h, machine* m, unsigned long cible){
+
+    int i = h->nb_instantanes - 1;
+    while ((i > 0) && (h->instantanes[i].compteur > cible)) i--;
+    const instantane* s = &h->instantanes[i];
+    memcpy(m->RAM, s->RAM, sizeof(m->RAM));
+    m->PC = s->PC;
+    m->accumulateur = s->accumulateur;
+    m->pos_entree = s->pos_entree;
+    m->compteur = s->compteur;
+    // l'anneau repart d'ici
+    h->plus_ancien = s->compteur;}
+
+
+// amène la machine à cible cycles exécutés (en avant ou en arrière)
+bool historique_aller(historique* h, machine* m, unsigned long cible){
+
+    if (cible < m->compteur){
+        if (cible < h->plus_ancien) restaurer(h, m, cible);
+        while (m->compteur > cible) annuler(h, m);}
+
+    while (m->compteur < cible) if (!avancer(h, m)) return false;
+    return true;}
+
+
+// le point d'arrêt en adresse a compté un passage au cycle n°cycle
+void historique_passage(historique* h, unsigned long cycle, int adresse){
+
+    if (h->nb_passages == h->capacite_passages){
+        h->capacite_passages = h->capacite_passages ? 2 * h->capacite_passages : 64;
+        h->passages = realloc(h->passages, h->capacite_passages * sizeof(passage_point));
+        if (!h->passages) {
+            perror("allocation des passages (historique_passage)");
+            exit(EXIT_FAILURE);}}
+    h->passages[h->nb_passages++] = (passage_point) { cycle, adresse };}
+
+
+// retire les passages des cycles après m->compteur (le cycle en cours,
+// n°m->compteur + 1, sera de nouveau examiné)
+void historique_defaire_passages(historique* h, const machine* m, unsigned long* passages){
+
+    while ((h->nb_passages > 0) && (h->passages[h->nb_passages-1].cycle > m->compteur)){
+        int a = h->passages[--h->nb_passages].adresse;
+        if (passages[a] > 0) passages[a]--;}} // remis à 0 entre-temps par break / delete
+
+
+// le PC touche-t-il un point d'arrêt ? (tableau de TAILLE_RAM bits)
+static inline bool touche(int PC, const uint64_t* adresses){
+    return (adresses[PC >> 6] >> (PC & 63)) & 1;}
+
+
+// remonte au dernier passage par le point d'arrêt adresse
+bool historique_point_arret(historique* h, machine* m, const uint64_t* adresses){
+
+    // d'abord dans l'anneau, cycle par cycle
+    while (m->compteur > h->plus_ancien){
+        annuler(h, m);
+        if (touche(m->PC, adresses)) return true;}
+
+    // puis d'instantané en instantané: on ré-exécute [début, limite)
+    // et on garde le dernier passage
+    unsigned long limite = m->compteur;
+    int i = h->nb_instantanes - 1;
+    while ((i >= 0) && (h->instantanes[i].compteur >= limite)) i--;
+
+    for (; i >= 0; i--){
+        unsigned long debut = h->instantanes[i].compteur, passage = limite;
+        restaurer(h, m, debut);
+        while (m->compteur < limite){
+            if (touche(m->PC, adresses)) passage = m->compteur;
+            avancer(h, m);}
+        if (passage < limite) return historique_aller(h, m, passage);
+        limite = debut;}
+
+    historique_aller(h, m, 0);
+    return false;}
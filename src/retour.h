@@ -0,0 +1,121 @@
+/* *******************************************************
+ * Nom           : retour.h
+ * Rôle          : Exécution à rebours pour le stepper
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Pendant le stepper, chaque cycle note de quoi être
+ *                 annulé (PC, accumulateur, mot de RAM[] écrasé): un
+ *                 anneau des NB_ANNULATIONS derniers cycles. Tous les
+ *                 "intervalle" cycles, un instantané complet (RAM[] et
+ *                 registres) est gardé.
+ *
+ *                 Reculer de N cycles annule N entrées de l'anneau; plus
+ *                 loin, on repart de l'instantané précédent et on
+ *                 ré-exécute jusqu'au cycle voulu. Les valeurs lues par
+ *                 IN@ sont gardées: la ré-exécution les relit au lieu de
+ *                 les redemander.
+ *
+ *                 Les passages comptés par les points d'arrêt (passage=N)
+ *                 sont notés avec leur cycle: un retour défait ceux des
+ *                 cycles annulés.
+ *
+ *                 Mémoire bornée: quand les NB_INSTANTANES sont pris, un
+ *                 instantané sur deux est oublié et l'intervalle double.
+ *                 Seules les entrées de IN@ (1 mot chacune) s'ajoutent.
+ *
+ * ****************************************************** */
+
+#ifndef RETOUR_H
+#define RETOUR_H
+
+#include <stdint.h>
+#include "machine.h"
+
+// cycles annulables sans instantané (puissance de 2)
+#define NB_ANNULATIONS 65536
+
+// instantanés gardés au plus (moins si la RAM[] est grande)
+#if TAILLE_RAM <= 256
+#define NB_INSTANTANES 1024
+#else
+#define NB_INSTANTANES 128
+#endif
+
+// intervalle par défaut entre deux instantanés (cycles)
+#define INTERVALLE_INSTANTANES 1024
+
+// drapeaux d'une annulation
+enum { ANNULER_ECRITURE = 1, ANNULER_ENTREE = 2 };
+
+// état avant un cycle, de quoi l'annuler
+typedef struct {
+    int32_t accumulateur;
+    mot PC;
+    mot adresse; // mot écrit par le cycle
+    mot ancienne; // sa valeur avant le cycle
+    uint8_t drapeaux;
+} annulation;
+
+// machine complète au début d'un cycle
+typedef struct {
+    unsigned long compteur;
+    int PC;
+    int accumulateur;
+    size_t pos_entree;
+    mot RAM[TAILLE_RAM];
+} instantane;
+
+// un passage compté par le point d'arrêt en adresse
+typedef struct {
+    unsigned long cycle;
+    int adresse;
+} passage_point;
+
+// historique d'une exécution au stepper
+typedef struct {
+    annulation* annulations; // cycle c en c % NB_ANNULATIONS
+    annulation* courante; // annulation du cycle en cours
+    unsigned long plus_ancien; // plus ancien cycle encore annulable
+    instantane* instantanes; // par compteur croissant
+    int nb_instantanes;
+    unsigned long intervalle;
+    mot* entrees; // toutes les valeurs lues par IN@ et IN*@
+    size_t nb_entrees;
+    size_t capacite_entrees;
+    passage_point* passages; // par cycle croissant
+    size_t nb_passages;
+    size_t capacite_passages;
+} historique;
+
+// historique vide, un instantané tous les intervalle cycles
+void historique_init(historique* h, unsigned long intervalle);
+
+void historique_liberer(historique* h);
+
+// avant d'exécuter le cycle m->compteur + 1: note l'annulation,
+// l'instantané éventuel, et relit les entrées déjà données
+void historique_avant(historique* h, machine* m);
+
+// après le cycle: garde la valeur lue au clavier par IN@ / IN*@
+void historique_apres(historique* h, machine* m);
+
+// amène la machine à cible cycles exécutés (en avant ou en arrière)
+// en avant, s'arrête avant un OUT; renvoie false si cible non atteinte
+bool historique_aller(historique* h, machine* m, unsigned long cible);
+
+// le point d'arrêt en adresse a compté un passage au cycle n°cycle
+void historique_passage(historique* h, unsigned long cycle, int adresse);
+
+// après un déplacement: retire de passages[] (compteurs des points
+// d'arrêt) les passages des cycles qui ne sont plus exécutés
+void historique_defaire_passages(historique* h, const machine* m, unsigned long* passages);
+
+// remonte au dernier passage du PC par une des adresses (TAILLE_RAM bits,
+// sans les conditions), false si aucun: la machine est alors au début
+bool historique_point_arret(historique* h, machine* m, const uint64_t* adresses);
+
+#endif
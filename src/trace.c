@@ -0,0 +1,102 @@
+/* *******************************************************
+ * Nom           : trace.c
+ * Rôle          : Trace binaire des cycles de l'ordinateur papier
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Rotation de TRACE_NB_BLOCS blocs entre l'émulateur
+ *                 (qui remplit) et le thread d'écriture (qui vide).
+ *                 L'émulateur n'attend que si tous les blocs sont pleins,
+ *                 c'est-à-dire si le disque ne suit pas.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include "trace.h"
+
+
+// thread d'écriture: écrit les blocs pleins dans l'ordre
+static void* ecrire_blocs(void* arg){
+
+    trace_binaire* t = arg;
+
+    pthread_mutex_lock(&t->verrou);
+    while (true){
+        while ((t->remplis[t->a_ecrire] == 0) && !t->fin) pthread_cond_wait(&t->plein, &t->verrou);
+        size_t n = t->remplis[t->a_ecrire];
+        if (n == 0) break; // fin et plus rien à écrire
+
+        // écriture hors du verrou: l'émulateur continue pendant ce temps
+        pthread_mutex_unlock(&t->verrou);
+        bool ok = (fwrite(t->blocs[t->a_ecrire], sizeof(enregistrement_trace), n, t->fichier) == n);
+        pthread_mutex_lock(&t->verrou);
+
+        if (!ok) t->erreur = true;
+        t->remplis[t->a_ecrire] = 0;
+        t->a_ecrire = (t->a_ecrire + 1) % TRACE_NB_BLOCS;
+        pthread_cond_signal(&t->libre);}
+    pthread_mutex_unlock(&t->verrou);
+    return NULL;}
+
+
+// crée le fichier et lance le thread d'écriture, false si erreur
+bool trace_ouvrir(trace_binaire* t, const char* chemin){
+
+    entete_trace entete = { .magie = "CX25TRC", .version = TRACE_VERSION, .taille = sizeof(enregistrement_trace) };
+    int i;
+
+    memset(t, 0, sizeof(*t));
+    t->fichier = fopen(chemin, "wb");
+    if (!t->fichier) return false;
+    if (fwrite(&entete, sizeof(entete), 1, t->fichier) != 1) {fclose(t->fichier); return false;}
+
+    for (i=0; i < TRACE_NB_BLOCS; i++){
+        t->blocs[i] = malloc(TRACE_BLOC * sizeof(enregistrement_trace));
+        if (!t->blocs[i]) {
+            perror("allocation de la trace (trace_ouvrir)");
+            exit(EXIT_FAILURE);}}
+
+    pthread_mutex_init(&t->verrou, NULL);
+    pthread_cond_init(&t->plein, NULL);
+    pthread_cond_init(&t->libre, NULL);
+    if (pthread_create(&t->ecrivain, NULL, ecrire_blocs, t) != 0) {
+        perror("thread d'écriture de la trace (trace_ouvrir)");
+        exit(EXIT_FAILURE);}
+    return true;}
+
+
+// passe le bloc courant au thread d'écriture (bloc plein)
+void trace_livrer(trace_binaire* t){
+
+    pthread_mutex_lock(&t->verrou);
+    t->remplis[t->courant] = t->pos;
+    pthread_cond_signal(&t->plein);
+
+    // bloc suivant, dès que le thread l'a vidé
+    t->courant = (t->courant + 1) % TRACE_NB_BLOCS;
+    while (t->remplis[t->courant] != 0) pthread_cond_wait(&t->libre, &t->verrou);
+    pthread_mutex_unlock(&t->verrou);
+    t->pos = 0;}
+
+
+// écrit les derniers enregistrements et ferme, false si erreur
+bool trace_fermer(trace_binaire* t){
+
+    int i;
+    if (t->pos > 0) trace_livrer(t);
+
+    pthread_mutex_lock(&t->verrou);
+    t->fin = true;
+    pthread_cond_signal(&t->plein);
+    pthread_mutex_unlock(&t->verrou);
+    pthread_join(t->ecrivain, NULL);
+
+    pthread_mutex_destroy(&t->verrou);
+    pthread_cond_destroy(&t->plein);
+    pthread_cond_destroy(&t->libre);
+    for (i=0; i < TRACE_NB_BLOCS; i++) free(t->blocs[i]);
+    if (fclose(t->fichier) != 0) t->erreur = true;
+    return !t->erreur;}
@@ -0,0 +1,114 @@
+/* *******************************************************
+ * Nom           : trace.h
+ * Rôle          : Trace binaire des cycles de l'ordinateur papier
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Un enregistrement de 16 bytes par cycle (machine par
+ *                 défaut, un peu plus avec des mots de 16 bits; au lieu de
+ *                 ~200 bytes de texte pour le journal): numéro de cycle,
+ *                 PC, opcode, argument, accumulateur et l'écriture en
+ *                 RAM[] faite par l'instruction.
+ *                 Les enregistrements sont rangés dans de grands blocs;
+ *                 un bloc plein est écrit dans le fichier par un thread
+ *                 en arrière-plan pendant que l'émulateur remplit le
+ *                 suivant. cx25_trace relit le fichier et régénère le
+ *                 journal texte.
+ *
+ *                 Fichier: une entete_trace puis les enregistrements
+ *                 (ordre des bytes de la machine qui écrit).
+ *
+ * ****************************************************** */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "machine.h"
+
+// enregistrements par bloc (1 Mo) et nombre de blocs en rotation
+#define TRACE_BLOC 65536
+#define TRACE_NB_BLOCS 4
+
+// version du format de fichier
+#define TRACE_VERSION 1
+
+// l'instruction a écrit valeur_ecrite dans RAM[adresse_ecrite]
+#define TRACE_ECRITURE 1
+
+// début du fichier
+typedef struct {
+    char magie[8]; // "CX25TRC"
+    uint32_t version;
+    uint32_t taille; // sizeof(enregistrement_trace)
+} entete_trace;
+
+// un cycle, état avant l'instruction
+typedef struct {
+    uint32_t compteur; // 32 bits de poids faible du numéro de cycle
+    int32_t accumulateur;
+    mot PC;
+    mot opcode;
+    mot argument;
+    uint8_t drapeaux;
+    mot adresse_ecrite;
+    mot valeur_ecrite;
+    uint8_t reserve[2];
+} enregistrement_trace;
+
+// fichier de trace en cours d'écriture
+typedef struct {
+    FILE* fichier;
+    enregistrement_trace* blocs[TRACE_NB_BLOCS];
+    size_t remplis[TRACE_NB_BLOCS]; // enregistrements à écrire, 0 = bloc libre
+    int courant; // bloc rempli par l'émulateur
+    size_t pos; // prochain enregistrement du bloc courant
+    int a_ecrire; // prochain bloc écrit par le thread
+    bool fin;
+    bool erreur;
+    pthread_t ecrivain;
+    pthread_mutex_t verrou;
+    pthread_cond_t plein, libre;
+} trace_binaire;
+
+// crée le fichier et lance le thread d'écriture, false si erreur
+bool trace_ouvrir(trace_binaire* t, const char* chemin);
+
+// écrit les derniers enregistrements et ferme, false si erreur
+bool trace_fermer(trace_binaire* t);
+
+// passe le bloc courant au thread d'écriture (bloc plein)
+void trace_livrer(trace_binaire* t);
+
+
+// enregistre le cycle n°compteur avant l'exécution de l'instruction en PC
+static inline __attribute__((always_inline)) enregistrement_trace* trace_cycle(trace_binaire* t, unsigned long compteur, int PC, const mot* RAM, int accumulateur){
+
+    if (t->pos == TRACE_BLOC) trace_livrer(t);
+    enregistrement_trace* r = &t->blocs[t->courant][t->pos++];
+    r->compteur = (uint32_t) compteur;
+    r->accumulateur = accumulateur;
+    r->PC = PC;
+    r->opcode = RAM[PC];
+    r->argument = RAM[PC+1];
+    r->drapeaux = 0;
+
+    // adresse que l'instruction va écrire (valeur connue après)
+    switch (r->opcode){
+        case STORE_AT: case IN_AT: r->adresse_ecrite = ADRESSE(r->argument); r->drapeaux = TRACE_ECRITURE; break;
+        case STORE_STAR_AT: r->adresse_ecrite = ADRESSE(CASE(RAM, r->argument)); r->drapeaux = TRACE_ECRITURE; break;
+        default: r->adresse_ecrite = 0; break;}
+    r->valeur_ecrite = 0;
+    r->reserve[0] = r->reserve[1] = 0;
+    return r;}
+
+
+// complète l'enregistrement après l'exécution de l'instruction
+static inline __attribute__((always_inline)) void trace_ecriture(enregistrement_trace* r, const mot* RAM){
+    if (r->drapeaux & TRACE_ECRITURE) r->valeur_ecrite = RAM[r->adresse_ecrite];}
+
+#endif
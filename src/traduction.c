@@ -0,0 +1,246 @@
+/* *******************************************************
+ * Nom           : traduction.c
+ * Rôle          : Traduction d'un programme en C (option -compile)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Les instructions traduites sont celles atteignables
+ *                 depuis le début en suivant PC+2 et les cibles des
+ *                 sauts (les arguments sont fixes tant que le code
+ *                 n'est pas modifié). Elles sont écrites dans l'ordre
+ *                 des adresses; un goto n'est écrit que si l'instruction
+ *                 suivante n'est pas juste après.
+ *
+ *                 Deux passes: la première note les étiquettes et les
+ *                 sorties utilisées (gcc -Wall n'aime pas les autres),
+ *                 la seconde écrit.
+ *
+ *                 Code auto-modifié: une instruction dont un mot peut être
+ *                 écrit (cible constante de STORE@ / IN@, tout mot
+ *                 traduit s'il y a un STORE*@) est gardée: avant de
+ *                 l'exécuter, ses deux mots sont comparés à ceux de la
+ *                 traduction, sinon on reprend dans l'interpréteur. Les
+ *                 écritures elles-mêmes ne coûtent rien. L'interpréteur
+ *                 avance pas à pas et revient au code traduit dès qu'il
+ *                 atteint une instruction traduite intacte, si aucun mot
+ *                 traduit non gardé (écrit seulement par du code
+ *                 modifié, donc interprété) ne diffère de l'image.
+ *
+ *                 Les adresses constantes sont écrites déjà prises
+ *                 modulo TAILLE_RAM; le programme traduit se compile avec
+ *                 la même configuration de la machine (il le vérifie).
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include <stdarg.h>
+#include "traduction.h"
+
+// adresse lue dans RAM[a] par le programme traduit (*@)
+#if TAILLE_RAM == (1 << CX25_BITS_ACCUMULATEUR)
+#define LIRE_ADRESSE "RAM[0x" HEX_ADRESSE "]"
+#else
+#define LIRE_ADRESSE "ADRESSE(RAM[0x" HEX_ADRESSE "])"
+#endif
+
+// ce que la passe de repérage a vu
+typedef struct {
+    FILE* f; // NULL pendant le repérage
+    bool atteinte[TAILLE_RAM]; // instruction traduite
+    bool traduit[TAILLE_RAM]; // mot lu comme opcode ou argument
+    bool etiquette[TAILLE_RAM]; // cible d'un goto
+    bool ecrit[TAILLE_RAM]; // mot traduit écrit par STORE@ / IN@
+    bool reprise; // une écriture peut toucher le code
+    bool indirecte; // STORE*@: toutes les instructions gardées
+    bool hors_memoire;
+    bool arret; // OUT atteignable
+} traduction;
+
+
+// écrit seulement pendant la seconde passe
+static void ecrire(traduction* t, const char* format, ...){
+
+    if (!t->f) return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(t->f, format, args);
+    va_end(args);}
+
+
+// instructions atteignables depuis debut
+static void atteindre(traduction* t, const mot* RAM, int debut){
+
+    int pile[TAILLE_RAM], n = 0;
+    if (PC_VALIDE(debut)) {pile[n++] = debut; t->atteinte[debut] = true;}
+
+    while (n > 0){
+        int a = pile[--n], op = RAM[a], suivants[2], nb = 0, j;
+        t->traduit[a] = t->traduit[a+1] = true;
+        if ((op == OUT_SHARP) || (op == OUT_AT) || (op == OUT_STAR_AT)) continue;
+        if (op == JUMP_AT) suivants[nb++] = ADRESSE(RAM[a+1]);
+        else if (!nom_mnemonique[OPCODE(op)]) suivants[nb++] = a; // PC ne bouge pas
+        else {
+            suivants[nb++] = a + 2;
+            if ((op == BRN_AT) || (op == BRZ_AT)) suivants[nb++] = ADRESSE(RAM[a+1]);}
+        for (j=0; j < nb; j++)
+            if (PC_VALIDE(suivants[j]) && !t->atteinte[suivants[j]]) {
+                t->atteinte[suivants[j]] = true;
+                pile[n++] = suivants[j];}}}
+
+
+// saut vers cible (goto ou sortie de la mémoire)
+static void aller(traduction* t, int cible){
+
+    if (PC_VALIDE(cible)) {t->etiquette[cible] = true; ecrire(t, "goto L_" HEX_ADRESSE ";", cible);}
+    else {t->hors_memoire = true; ecrire(t, "SORTIR(0x" HEX_ADRESSE ");", cible);}}
+
+
+// une écriture en RAM[x] (x constant) qui peut toucher le code
+static void ecriture(traduction* t, int x){
+
+    if (!t->traduit[x]) return;
+    t->reprise = true;
+    t->ecrit[x] = true;}
+
+
+// un mot de l'instruction en a peut-il changer sous le code traduit ?
+static bool gardee(const traduction* t, int a){
+
+    return t->reprise && (t->indirecte || t->ecrit[a] || t->ecrit[a+1]);}
+
+
+// une instruction, suivie = adresse de l'instruction écrite après (-1: aucune)
+static void instruction(traduction* t, const mot* RAM, int a, int suivie){
+
+    int op = RAM[a], arg = RAM[a+1], x = ADRESSE(arg), n = a + 2;
+    const char* signe = ((op == SUB_SHARP) || (op == SUB_AT) || (op == SUB_STAR_AT)) ? "-" : "+";
+
+    if (t->etiquette[a]) ecrire(t, "L_" HEX_ADRESSE ": ", a);
+    ecrire(t, "// %s 0x" HEX_MOT "\n    ", nom_mnemonique[OPCODE(op)] ? nom_mnemonique[OPCODE(op)] : "inconnue", arg);
+    if (gardee(t, a))
+        ecrire(t, "if ((RAM[0x" HEX_ADRESSE "] != 0x" HEX_MOT ") || (RAM[0x" HEX_ADRESSE "] != 0x" HEX_MOT ")) REPRENDRE(0x" HEX_ADRESSE ");\n    ", a, op, a + 1, arg, a);
+    ecrire(t, "compteur++; ");
+
+    switch (op){
+        case ADD_SHARP: case SUB_SHARP: ecrire(t, "acc %s= 0x" HEX_MOT ";", signe, arg); break;
+        case ADD_AT: case SUB_AT: ecrire(t, "acc %s= RAM[0x" HEX_ADRESSE "];", signe, x); break;
+        case ADD_STAR_AT: case SUB_STAR_AT: ecrire(t, "acc %s= RAM[" LIRE_ADRESSE "];", signe, x); break;
+        case NAND_SHARP: ecrire(t, "acc = ~(acc & 0x" HEX_MOT ");", arg); break;
+        case NAND_AT: ecrire(t, "acc = ~(acc & RAM[0x" HEX_ADRESSE "]);", x); break;
+        case NAND_STAR_AT: ecrire(t, "acc = ~(acc & RAM[" LIRE_ADRESSE "]);", x); break;
+        case LOAD_SHARP: ecrire(t, "acc = 0x" HEX_MOT ";", arg); break;
+        case LOAD_AT: ecrire(t, "acc = RAM[0x" HEX_ADRESSE "];", x); break;
+        case LOAD_STAR_AT: ecrire(t, "acc = RAM[" LIRE_ADRESSE "];", x); break;
+        case STORE_AT: ecrire(t, "RAM[0x" HEX_ADRESSE "] = acc;", x); ecriture(t, x); break;
+        case STORE_STAR_AT: t->reprise = t->indirecte = true; ecrire(t, "RAM[" LIRE_ADRESSE "] = acc;", x); break;
+        case IN_AT: ecrire(t, "lire_entree(&m, &RAM[0x" HEX_ADRESSE "]); vider_ligne();", x); ecriture(t, x); break;
+        case IN_STAR_AT: ecrire(t, "vider_ligne();"); break;
+        case OUT_SHARP: t->arret = true; ecrire(t, "ARRETER(0x" HEX_ADRESSE ", 0x" HEX_MOT ");\n", a, arg); return;
+        case OUT_AT: t->arret = true; ecrire(t, "ARRETER(0x" HEX_ADRESSE ", RAM[0x" HEX_ADRESSE "]);\n", a, x); return;
+        case OUT_STAR_AT: t->arret = true; ecrire(t, "ARRETER(0x" HEX_ADRESSE ", RAM[" LIRE_ADRESSE "]);\n", n, x); return;
+        case JUMP_AT: aller(t, x); ecrire(t, "\n"); return;
+        case BRN_AT: ecrire(t, "if (acc & 0x%X) ", BIT_SIGNE); aller(t, x); break;
+        case BRZ_AT: ecrire(t, "if (acc == 0) "); aller(t, x); break;
+        default: aller(t, a); ecrire(t, "\n"); return;} // PC ne bouge pas
+
+    if (n != suivie) {ecrire(t, " "); aller(t, n);}
+    ecrire(t, "\n");}
+
+
+// toutes les instructions dans l'ordre des adresses
+static void corps(traduction* t, const mot* RAM, int debut){
+
+    int a;
+    ecrire(t, "    ");
+    aller(t, debut);
+    ecrire(t, "\n\n");
+    for (a=0; a < TAILLE_RAM; a++){
+        if (!t->atteinte[a]) continue;
+        int b = a + 1;
+        while ((b < TAILLE_RAM) && !t->atteinte[b]) b++;
+        instruction(t, RAM, a, (b < TAILLE_RAM) ? b : -1);}}
+
+
+// tableau de TAILLE_RAM mots en C, 16 par ligne
+static void tableau(traduction* t, const char* commentaire, const char* nom, const mot* valeurs){
+
+    int a;
+    ecrire(t, "// %s\nstatic const mot %s[TAILLE_RAM] = {", commentaire, nom);
+    for (a=0; a < TAILLE_RAM; a++) ecrire(t, "%s0x" HEX_MOT "%s", (a % 16) ? " " : "\n    ", valeurs[a], (a < TAILLE_RAM - 1) ? "," : "");
+    ecrire(t, " };\n\n");}
+
+
+// écrit le programme C équivalent à RAM[] lancé en debut
+bool traduire_programme(FILE* f, const mot* RAM, int debut, const char* programme){
+
+    traduction t;
+    memset(&t, 0, sizeof(t));
+    atteindre(&t, RAM, debut);
+    corps(&t, RAM, debut); // repérage: étiquettes et sorties utilisées
+
+    // retour de l'interpréteur: toute instruction traduite est une étiquette;
+    // les mots traduits non gardés ne changent que sous l'interpréteur
+    mot natif[TAILLE_RAM], surveille[TAILLE_RAM];
+    int a;
+    for (a=0; a < TAILLE_RAM; a++){
+        natif[a] = t.atteinte[a];
+        surveille[a] = t.traduit[a] && !t.ecrit[a] && !t.indirecte;
+        if (t.reprise && t.atteinte[a]) t.etiquette[a] = true;}
+
+    t.f = f;
+    ecrire(&t, "/* Traduction en C de %s (début 0x" HEX_ADRESSE ") par ./cx25.1 -compile\n", programme, debut);
+    ecrire(&t, " * Compilation: make [nom]_natif (avec machine.o)\n");
+    ecrire(&t, " * Usage: ./[nom]_natif [-etat], entrées de IN@ sur stdin */\n\n");
+    ecrire(&t, "#include <string.h>\n#include \"machine.h\"\n\n");
+    ecrire(&t, "#if (TAILLE_RAM != %d) || (CX25_BITS_ACCUMULATEUR != %d)\n", TAILLE_RAM, CX25_BITS_ACCUMULATEUR);
+    ecrire(&t, "#error \"configuration de la machine différente de celle de la traduction\"\n#endif\n\n");
+    tableau(&t, "RAM[] au chargement", "image", RAM);
+    if (t.reprise){
+        tableau(&t, "instructions traduites: retour possible depuis l'interpréteur", "natif", natif);
+        if (!t.indirecte){
+            tableau(&t, "mots traduits non gardés: modifiés, ils retiennent l'interpréteur", "surveille", surveille);
+            ecrire(&t, "// mot écrit par l'instruction en PC (-1: aucun)\nstatic int mot_ecrit(const mot* RAM, int PC){\n");
+            ecrire(&t, "    int acces = acces_opcode[OPCODE(RAM[PC])];\n");
+            ecrire(&t, "    if (acces & ACCES_ECRIT) return ADRESSE(RAM[PC+1]);\n");
+            ecrire(&t, "    if (acces & ACCES_ECRIT_IND) return ADRESSE(CASE(RAM, RAM[PC+1]));\n");
+            ecrire(&t, "    return -1;}\n\n");}}
+
+    ecrire(&t, "#define ARRETER(pc, valeur) do { m.resultat = (valeur); m.raison = ARRET_OUT; PC = (pc); goto fin; } while (0)\n");
+    if (t.reprise) ecrire(&t, "#define REPRENDRE(pc) do { PC = (pc); goto reprise; } while (0)\n");
+    if (t.hors_memoire) ecrire(&t, "#define SORTIR(pc) do { m.raison = ARRET_PC; PC = (pc); goto fin; } while (0)\n");
+
+    ecrire(&t, "\n\nint main(int k, char* ldc[]){\n\n");
+    ecrire(&t, "    machine m;\n    machine_init(&m, image, 0x" HEX_ADRESSE ");\n", debut);
+    bool fin = t.arret || t.hors_memoire; // sinon la boucle ne s'arrête pas
+    ecrire(&t, "    mot* RAM __attribute__((unused)) = m.RAM; // inutilisés dans un programme court\n");
+    ecrire(&t, "    int acc __attribute__((unused)) = 0%s;\n    unsigned long compteur = 0;\n", (fin || t.reprise) ? ", PC" : "");
+    if (t.reprise && !t.indirecte) ecrire(&t, "    bool sale[TAILLE_RAM] = { false }; // mots surveillés différents de l'image\n    int nb_sales = 0;\n");
+    ecrire(&t, "\n");
+    corps(&t, RAM, debut);
+
+    if (t.reprise){
+        ecrire(&t, "\n    // code modifié: l'interpréteur de référence, pas à pas, jusqu'à une\n");
+        ecrire(&t, "    // instruction traduite intacte, sans mot surveillé sale\n");
+        ecrire(&t, "reprise:\n    m.PC = PC; m.accumulateur = acc; m.compteur = compteur;\n    do {\n");
+        if (t.indirecte) ecrire(&t, "        machine_executer(&m, 1);\n");
+        else {
+            ecrire(&t, "        int x = mot_ecrit(RAM, m.PC);\n        machine_executer(&m, 1);\n");
+            ecrire(&t, "        if ((x >= 0) && surveille[x] && (sale[x] != (RAM[x] != image[x]))) {\n");
+            ecrire(&t, "            sale[x] = !sale[x];\n            nb_sales += sale[x] ? 1 : -1;}\n");}
+        ecrire(&t, "    } while ((m.raison == ARRET_BUDGET) && (%s!natif[m.PC] || (RAM[m.PC] != image[m.PC]) || (RAM[m.PC+1] != image[m.PC+1])));\n", t.indirecte ? "" : "nb_sales || ");
+        ecrire(&t, "    if (m.raison != ARRET_BUDGET) goto afficher;\n");
+        ecrire(&t, "    PC = m.PC; acc = m.accumulateur; compteur = m.compteur;\n    switch (PC){\n");
+        for (a=0; a < TAILLE_RAM; a++)
+            if (t.atteinte[a]) ecrire(&t, "        case 0x" HEX_ADRESSE ": goto L_" HEX_ADRESSE ";\n", a, a);
+        ecrire(&t, "        default: goto afficher;} // natif[PC]: impossible\n");}
+
+    if (fin) ecrire(&t, "\nfin:\n    m.PC = PC; m.accumulateur = acc; m.compteur = compteur;\n");
+    if (t.reprise) ecrire(&t, "afficher:\n");
+    ecrire(&t, "    if (m.raison == ARRET_OUT) printf(\"0x%s\\n\", m.resultat);\n", HEX_MOT);
+    ecrire(&t, "    if ((k > 1) && (strcmp(ldc[1], \"-etat\") == 0))\n");
+    ecrire(&t, "        fprintf(stderr, \"PC 0x%s accumulateur 0x%s cycles %%lu raison %%s\\n\", m.PC, m.accumulateur, m.compteur, nom_raison[m.raison]);\n", HEX_ADRESSE, HEX_MOT);
+    ecrire(&t, "    return 0;}\n");
+    return !ferror(f);}
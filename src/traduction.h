@@ -0,0 +1,43 @@
+/* *******************************************************
+ * Nom           : traduction.h
+ * Rôle          : Traduction d'un programme en C (option -compile)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Écrit la RAM[] chargée sous forme d'une unité de
+ *                 traduction C: chaque instruction atteignable depuis
+ *                 le début devient une étiquette et quelques lignes de
+ *                 C, JUMP@ / BRN@ / BRZ@ des goto. Les arguments sont
+ *                 des constantes: le compilateur voit les adresses.
+ *
+ *                 Une écriture (STORE@, STORE*@, IN@) dans un mot
+ *                 traduit rend le code faux: une instruction qu'une
+ *                 écriture peut atteindre vérifie d'abord ses deux mots
+ *                 et, s'ils ont changé, le programme reprend dans
+ *                 machine_executer(), l'interpréteur de référence. Il
+ *                 revient au code traduit dès qu'une instruction
+ *                 traduite est intacte. Le code auto-modifié reste
+ *                 juste.
+ *
+ *                 Le programme traduit se comporte comme
+ *                 "./cx25.1 programme.txt 0x[début] -quiet" (IN@ lus sur
+ *                 stdin, résultat de OUT affiché); "-etat" affiche en
+ *                 plus PC, accumulateur, cycles et raison sur stderr.
+ *                 Il se compile avec machine.o:
+ *                      make programme_natif
+ *
+ * ****************************************************** */
+
+#ifndef TRADUCTION_H
+#define TRADUCTION_H
+
+#include "machine.h"
+
+// écrit dans f le programme C équivalent à RAM[] lancé en debut,
+// false si erreur d'écriture (errno)
+bool traduire_programme(FILE* f, const mot* RAM, int debut, const char* programme);
+
+#endif
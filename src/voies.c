@@ -0,0 +1,224 @@
+/* *******************************************************
+ * Nom           : voies.c
+ * Rôle          : Machines de l'ordinateur papier en parallèle (SIMD)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Interpréteur vectoriel: un pas exécute une instruction
+ *                 pour toutes les voies sélectionnées par un masque.
+ *                 Le coeur (voies_coeur.h) est compilé pour AVX-512, AVX2
+ *                 et une version de base; la bonne est choisie au
+ *                 lancement selon le processeur.
+ *
+ * ****************************************************** */
+
+#include <string.h>
+#include <limits.h>
+#include "voies.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+// numéro de chaque voie
+static const vecteur numero_voie = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 };
+
+
+// toutes les voies reçoivent la même image mémoire et le même début
+void voies_init(voies* v, const mot* image, int debut){
+
+    int a, l;
+    for (a=0; a < TAILLE_RAM; a++)
+        for (l=0; l < NB_VOIES; l++) v->RAM[a][l] = image[a];
+    memset(v->entrees, 0, sizeof(v->entrees));
+
+    vecteur zero = {0};
+    v->PC = zero + debut;
+    v->accumulateur = zero;
+    v->compteur = zero;
+    v->resultat = zero - 1;
+    v->pos_entree = zero;
+    v->nb_entrees = zero;
+    v->actives = zero - 1;
+    for (l=0; l < NB_VOIES; l++) v->raison[l] = ARRET_AUCUN;}
+
+
+// entrées de IN@ d'une voie (au plus NB_ENTREES_VOIE)
+void voies_entrees(voies* v, int voie, const mot* entrees, int nb){
+
+    if (nb > NB_ENTREES_VOIE) nb = NB_ENTREES_VOIE;
+    int i;
+    for (i=0; i < nb; i++) v->entrees[i][voie] = entrees[i];
+    v->nb_entrees[voie] = nb;}
+
+
+// indice de RAM[adresses[voie]][voie] dans le tableau à plat
+static inline __attribute__((always_inline)) vecteur indices_voies(vecteur adresses){
+    return adresses * NB_VOIES + numero_voie;}
+
+
+// choisit a sur les voies du masque, b ailleurs
+static inline __attribute__((always_inline)) vecteur choisir(vecteur masque, vecteur a, vecteur b){
+    return (a & masque) | (b & ~masque);}
+
+
+// lit RAM[adresses[voie]][voie] pour chaque voie (gather), version de base
+static inline __attribute__((always_inline)) vecteur rassembler_base(const int32_t* base, vecteur adresses){
+
+    vecteur r, indices = indices_voies(adresses);
+    int l;
+    for (l=0; l < NB_VOIES; l++) r[l] = base[indices[l]];
+    return r;}
+
+
+// écrit valeurs dans RAM[adresses[voie]][voie] pour les voies du masque (scatter)
+static inline __attribute__((always_inline)) void disperser_base(int32_t* base, vecteur adresses, vecteur valeurs, vecteur masque){
+
+    vecteur indices = indices_voies(adresses);
+    int l;
+    for (l=0; l < NB_VOIES; l++) if (masque[l]) base[indices[l]] = valeurs[l] & MASQUE_MOT;}
+
+
+// minimum de toutes les voies (en log2(NB_VOIES) permutations)
+static inline __attribute__((always_inline)) int32_t minimum_base(vecteur x){
+
+    static const vecteur rotation8 = { 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7 };
+    static const vecteur rotation4 = { 4, 5, 6, 7, 0, 1, 2, 3, 12, 13, 14, 15, 8, 9, 10, 11 };
+    static const vecteur rotation2 = { 2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13 };
+    static const vecteur rotation1 = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+    vecteur y;
+    y = __builtin_shuffle(x, rotation8); x = choisir(x < y, x, y);
+    y = __builtin_shuffle(x, rotation4); x = choisir(x < y, x, y);
+    y = __builtin_shuffle(x, rotation2); x = choisir(x < y, x, y);
+    y = __builtin_shuffle(x, rotation1); x = choisir(x < y, x, y);
+    return x[0];}
+
+
+// bits des voies du masque (bit l = voie l)
+static inline __attribute__((always_inline)) unsigned bits_base(vecteur masque){
+
+    unsigned bits = 0;
+    int l;
+    for (l=0; l < NB_VOIES; l++) bits |= (masque[l] & 1u) << l;
+    return bits;}
+
+
+// version de base (tout processeur)
+#define VOIES_NOM executer_base
+#define RASSEMBLER rassembler_base
+#define DISPERSER disperser_base
+#define MINIMUM minimum_base
+#define BITS bits_base
+#include "voies_coeur.h"
+
+#if defined(__x86_64__)
+
+// version AVX2: deux gathers de 8 voies
+#pragma GCC push_options
+#pragma GCC target("avx2")
+static inline __attribute__((always_inline)) vecteur rassembler_avx2(const int32_t* base, vecteur adresses){
+
+    vecteur r, indices = indices_voies(adresses);
+    __m256i bas, haut;
+    memcpy(&bas, &indices, sizeof(bas));
+    memcpy(&haut, (char*) &indices + sizeof(bas), sizeof(haut));
+    bas = _mm256_i32gather_epi32((const int*) base, bas, 4);
+    haut = _mm256_i32gather_epi32((const int*) base, haut, 4);
+    memcpy(&r, &bas, sizeof(bas));
+    memcpy((char*) &r + sizeof(bas), &haut, sizeof(haut));
+    return r;}
+
+static inline __attribute__((always_inline)) unsigned bits_avx2(vecteur masque){
+
+    __m256i bas, haut;
+    memcpy(&bas, &masque, sizeof(bas));
+    memcpy(&haut, (char*) &masque + sizeof(bas), sizeof(haut));
+    return (unsigned) _mm256_movemask_ps((__m256) bas) | ((unsigned) _mm256_movemask_ps((__m256) haut) << 8);}
+
+#define VOIES_NOM executer_avx2
+#define RASSEMBLER rassembler_avx2
+#define DISPERSER disperser_base
+#define MINIMUM minimum_base
+#define BITS bits_avx2
+#include "voies_coeur.h"
+#pragma GCC pop_options
+
+// version AVX-512: gather, scatter et réductions sur 16 voies
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+static inline __attribute__((always_inline)) vecteur rassembler_avx512(const int32_t* base, vecteur adresses){
+    return (vecteur) _mm512_i32gather_epi32((__m512i) indices_voies(adresses), base, 4);}
+
+static inline __attribute__((always_inline)) void disperser_avx512(int32_t* base, vecteur adresses, vecteur valeurs, vecteur masque){
+    _mm512_mask_i32scatter_epi32(base, _mm512_test_epi32_mask((__m512i) masque, (__m512i) masque), (__m512i) indices_voies(adresses), (__m512i) (valeurs & MASQUE_MOT), 4);}
+
+static inline __attribute__((always_inline)) int32_t minimum_avx512(vecteur x){
+    return _mm512_reduce_min_epi32((__m512i) x);}
+
+static inline __attribute__((always_inline)) unsigned bits_avx512(vecteur masque){
+    return _mm512_test_epi32_mask((__m512i) masque, (__m512i) masque);}
+
+#define VOIES_NOM executer_avx512
+#define RASSEMBLER rassembler_avx512
+#define DISPERSER disperser_avx512
+#define MINIMUM minimum_avx512
+#define BITS bits_avx512
+#include "voies_coeur.h"
+#pragma GCC pop_options
+
+#endif
+
+
+// exécute toutes les voies avec la meilleure version du processeur
+void voies_executer(voies* v, unsigned long budget){
+
+#if defined(__x86_64__)
+    if (__builtin_cpu_supports("avx512f")) {executer_avx512(v, budget); return;}
+    if (__builtin_cpu_supports("avx2")) {executer_avx2(v, budget); return;}
+#endif
+    executer_base(v, budget);}
+
+
+// exécute le programme pour toutes les valeurs des nb premières entrées
+// les voies d'un même vecteur ne diffèrent que par la première entrée:
+// leurs chemins d'exécution restent proches et divergent peu
+void balayer_entrees(const mot* image, int debut, int nb, unsigned long budget, FILE* sortie){
+
+    static voies v; // 16 Ko par défaut: hors de la pile
+    unsigned long total = 1UL << (8*nb), groupe, reste_bits = 8*(nb-1);
+    mot* resultats = malloc(total * sizeof(mot));
+    unsigned char* raisons = malloc(total);
+    int l, i;
+
+    if (!resultats || !raisons) {
+        perror("allocation du balayage (balayer_entrees)");
+        exit(EXIT_FAILURE);}
+
+    for (groupe=0; groupe < total / NB_VOIES; groupe++){
+        voies_init(&v, image, debut);
+
+        // première entrée = numéro de voie + 16 * (groupe % 16), les autres = groupe / 16
+        unsigned long reste = groupe / (256 / NB_VOIES);
+        unsigned long premiere = (groupe % (256 / NB_VOIES)) * NB_VOIES;
+        for (l=0; l < NB_VOIES; l++){
+            mot entrees[NB_ENTREES_VOIE];
+            unsigned long combinaison = ((premiere + l) << reste_bits) | reste;
+            for (i=0; i < nb; i++) entrees[i] = (combinaison >> (8*(nb-1-i))) & 0xFF;
+            voies_entrees(&v, l, entrees, nb);}
+
+        voies_executer(&v, budget);
+
+        for (l=0; l < NB_VOIES; l++){
+            unsigned long combinaison = ((premiere + l) << reste_bits) | reste;
+            resultats[combinaison] = v.resultat[l];
+            raisons[combinaison] = v.raison[l];}}
+
+    // une ligne par combinaison, dans l'ordre
+    for (groupe=0; groupe < total; groupe++){
+        for (i=0; i < nb; i++) fprintf(sortie, "0x%02lx ", (groupe >> (8*(nb-1-i))) & 0xFF);
+        if (raisons[groupe] == ARRET_OUT) fprintf(sortie, "-> 0x" HEX_MOT "\n", resultats[groupe]);
+        else fprintf(sortie, "-> - %s\n", nom_raison[raisons[groupe]]);}
+
+    free(resultats); free(raisons);}
@@ -0,0 +1,68 @@
+/* *******************************************************
+ * Nom           : voies.h
+ * Rôle          : Machines de l'ordinateur papier en parallèle (SIMD)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : NB_VOIES machines exécutent le même programme en même
+ *                 temps, une par voie d'un registre vectoriel. Chaque voie
+ *                 a ses entrées de IN@ et peut avoir sa propre RAM[], son
+ *                 PC et son accumulateur. La RAM[] est transposée
+ *                 (RAM[adresse][voie]): l'opcode et l'argument d'une
+ *                 adresse se chargent en un vecteur, les accès @ et *@
+ *                 deviennent des "gathers".
+ *
+ *                 Quand les PC divergent, on exécute à chaque pas les
+ *                 voies du plus petit PC (et du même opcode) sous masque,
+ *                 les autres voies attendent: elles se rejoignent en fin
+ *                 de boucle.
+ *
+ * ****************************************************** */
+
+#ifndef VOIES_H
+#define VOIES_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "machine.h"
+
+// nombre de machines par vecteur
+#define NB_VOIES 16
+
+// nombre maximal d'entrées de IN@ par voie
+#define NB_ENTREES_VOIE 8
+
+// un entier 32 bits par voie
+typedef int32_t vecteur __attribute__((vector_size(NB_VOIES * sizeof(int32_t))));
+
+// NB_VOIES machines exécutées en parallèle
+typedef struct {
+    int32_t RAM[TAILLE_RAM][NB_VOIES] __attribute__((aligned(64))); // RAM[adresse][voie]
+    int32_t entrees[NB_ENTREES_VOIE][NB_VOIES] __attribute__((aligned(64)));
+    vecteur PC;
+    vecteur accumulateur;
+    vecteur compteur;
+    vecteur resultat; // valeur de OUT, -1 si aucune
+    vecteur pos_entree;
+    vecteur nb_entrees;
+    vecteur actives; // -1 tant que la voie tourne, 0 sinon
+    raison_arret raison[NB_VOIES];
+} voies;
+
+// toutes les voies reçoivent la même image mémoire et le même début
+void voies_init(voies* v, const mot* image, int debut);
+
+// entrées de IN@ d'une voie (au plus NB_ENTREES_VOIE)
+void voies_entrees(voies* v, int voie, const mot* entrees, int nb);
+
+// exécute toutes les voies jusqu'à leur arrêt (budget de cycles par voie)
+void voies_executer(voies* v, unsigned long budget);
+
+// exécute le programme pour toutes les valeurs des nb premières entrées
+// de IN@ entre 0x00 et 0xFF (256^nb combinaisons), une ligne par combinaison dans sortie
+void balayer_entrees(const mot* image, int debut, int nb, unsigned long budget, FILE* sortie);
+
+#endif
@@ -0,0 +1,131 @@
+/* *******************************************************
+ * Nom           : voies_coeur.h
+ * Rôle          : Coeur de l'interpréteur vectoriel (gabarit)
+ * Auteur        : Avrile Floro
+ * Version       : 1.0
+ * Date          : 2023-03-25
+ * Licence       : L1 prog_imperative
+ * *******************************************************
+ *
+ * Description   : Inclus une fois par jeu d'instructions par voies.c,
+ *                 qui définit avant l'inclusion:
+ *                      VOIES_NOM : nom de la fonction générée
+ *                      RASSEMBLER(base, adresses) : gather
+ *                      DISPERSER(base, adresses, valeurs, masque) : scatter
+ *                      MINIMUM(x) : minimum des voies
+ *                      BITS(masque) : une voie par bit
+ *
+ * ****************************************************** */
+
+// exécute toutes les voies jusqu'à leur arrêt (budget de cycles par voie)
+static void VOIES_NOM(voies* v, unsigned long budget){
+
+    int32_t* RAM = &v->RAM[0][0];
+    int32_t limite = ((budget == 0) || (budget > INT_MAX)) ? INT_MAX : (int32_t) budget;
+    vecteur PC = v->PC, acc = v->accumulateur, compteur = v->compteur;
+    vecteur actives = v->actives, vide = {0};
+    int l, pc_suivant = 0;
+    bool connu = false; // pc_suivant est le PC de toutes les voies actives
+
+    vide += INT_MAX; // valeur des voies ignorées dans les minimums
+
+    // voies arrêtées avant même de commencer
+    vecteur hors = actives & ((PC <= 0x1F) | (PC >= TAILLE_RAM - 1));
+    for (l=0; l < NB_VOIES; l++) if (hors[l]) v->raison[l] = ARRET_PC;
+    actives &= ~hors;
+
+    while (true){
+
+        // plus petit PC parmi les voies actives: ces voies avancent
+        // (inutile à chercher si toutes les voies ont avancé ensemble)
+        int pc = connu ? pc_suivant : MINIMUM(choisir(actives, PC, vide));
+        if (pc == INT_MAX) break;
+
+        // l'opcode et l'argument de pc, pour toutes les voies d'un coup
+        // (l'argument, adresse de @ et *@, pris modulo TAILLE_RAM)
+        vecteur opcode, argument;
+        memcpy(&opcode, v->RAM[pc], sizeof(vecteur));
+        memcpy(&argument, v->RAM[pc+1], sizeof(vecteur));
+        vecteur adresse = ADRESSE(argument);
+
+        // parmi elles, celles qui ont le même opcode (code auto-modifié):
+        // les autres attendent le pas suivant au même PC
+        vecteur meme_pc = actives & (PC == pc);
+        int op = v->RAM[pc][__builtin_ctz(BITS(meme_pc))];
+        vecteur m = meme_pc & (opcode == op);
+
+        compteur -= m; // m vaut -1 sur les voies exécutées
+        vecteur suivant = choisir(m, PC + 2, PC);
+        vecteur valeur;
+        unsigned toutes = BITS(actives);
+        connu = (BITS(m) == toutes);
+        pc_suivant = pc + 2;
+
+        switch (op){
+
+            case ADD_SHARP: acc = choisir(m, acc + argument, acc); PC = suivant; break;
+            case ADD_AT: acc = choisir(m, acc + RASSEMBLER(RAM, adresse), acc); PC = suivant; break;
+            case ADD_STAR_AT: valeur = RASSEMBLER(RAM, ADRESSE(RASSEMBLER(RAM, adresse)));
+                acc = choisir(m, acc + valeur, acc); PC = suivant; break;
+
+            case SUB_SHARP: acc = choisir(m, acc - argument, acc); PC = suivant; break;
+            case SUB_AT: acc = choisir(m, acc - RASSEMBLER(RAM, adresse), acc); PC = suivant; break;
+            case SUB_STAR_AT: valeur = RASSEMBLER(RAM, ADRESSE(RASSEMBLER(RAM, adresse)));
+                acc = choisir(m, acc - valeur, acc); PC = suivant; break;
+
+            case NAND_SHARP: acc = choisir(m, ~(acc & argument), acc); PC = suivant; break;
+            case NAND_AT: acc = choisir(m, ~(acc & RASSEMBLER(RAM, adresse)), acc); PC = suivant; break;
+            case NAND_STAR_AT: valeur = RASSEMBLER(RAM, ADRESSE(RASSEMBLER(RAM, adresse)));
+                acc = choisir(m, ~(acc & valeur), acc); PC = suivant; break;
+
+            case LOAD_SHARP: acc = choisir(m, argument, acc); PC = suivant; break;
+            case LOAD_AT: acc = choisir(m, RASSEMBLER(RAM, adresse), acc); PC = suivant; break;
+            case LOAD_STAR_AT: acc = choisir(m, RASSEMBLER(RAM, ADRESSE(RASSEMBLER(RAM, adresse))), acc); PC = suivant; break;
+
+            case STORE_AT: DISPERSER(RAM, adresse, acc, m); PC = suivant; break;
+            case STORE_STAR_AT: DISPERSER(RAM, ADRESSE(RASSEMBLER(RAM, adresse)), acc, m); PC = suivant; break;
+
+            case IN_AT: // chaque voie lit sa prochaine entrée
+                valeur = v->pos_entree < v->nb_entrees;
+                for (l=0; l < NB_VOIES; l++) if (m[l] && !valeur[l]) {v->raison[l] = ARRET_ENTREE;}
+                actives &= ~(m & ~valeur);
+                m &= valeur;
+                DISPERSER(RAM, adresse, RASSEMBLER(&v->entrees[0][0], v->pos_entree & (NB_ENTREES_VOIE-1)), m);
+                v->pos_entree -= m;
+                PC = choisir(m, PC + 2, PC); connu = false; break;
+
+            case IN_STAR_AT: // la ligne est consommée, rien n'est stocké
+                v->pos_entree -= m & (v->pos_entree < v->nb_entrees);
+                PC = suivant; break;
+
+            case OUT_SHARP: valeur = argument; goto sortie;
+            case OUT_AT: valeur = RASSEMBLER(RAM, adresse); goto sortie;
+            case OUT_STAR_AT: valeur = RASSEMBLER(RAM, ADRESSE(RASSEMBLER(RAM, adresse))); PC = suivant;
+            sortie:
+                v->resultat = choisir(m, valeur, v->resultat);
+                for (l=0; l < NB_VOIES; l++) if (m[l]) v->raison[l] = ARRET_OUT;
+                actives &= ~m; connu = false; break;
+
+            case JUMP_AT: PC = choisir(m, adresse, PC); connu = false; break;
+            case BRN_AT: PC = choisir(m & ((acc & BIT_SIGNE) != 0), adresse, suivant); connu = false; break;
+            case BRZ_AT: PC = choisir(m & (acc == 0), adresse, suivant); connu = false; break;
+
+            default: connu = false; break;} // instruction non reconnue: le PC ne bouge pas
+
+        // voies sorties de la mémoire ou au bout de leur budget
+        hors = actives & ((PC <= 0x1F) | (PC >= TAILLE_RAM - 1));
+        vecteur epuisees = actives & ~hors & (compteur >= limite);
+        if (BITS(hors | epuisees)){
+            for (l=0; l < NB_VOIES; l++){
+                if (hors[l]) v->raison[l] = ARRET_PC;
+                if (epuisees[l]) v->raison[l] = ARRET_BUDGET;}
+            actives &= ~(hors | epuisees);
+            connu = false;}}
+
+    v->PC = PC; v->accumulateur = acc; v->compteur = compteur; v->actives = actives;}
+
+#undef VOIES_NOM
+#undef RASSEMBLER
+#undef DISPERSER
+#undef MINIMUM
+#undef BITS